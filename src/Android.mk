@@ -68,19 +68,24 @@ COMMON_SRC_FILES += \
 	Renderer/Context.cpp \
 	Renderer/ETC_Decoder.cpp \
 	Renderer/Matrix.cpp \
+	Renderer/OutlineBuffer.cpp \
 	Renderer/PixelProcessor.cpp \
 	Renderer/Plane.cpp \
 	Renderer/Point.cpp \
 	Renderer/QuadRasterizer.cpp \
 	Renderer/Renderer.cpp \
+	Renderer/RoutineArchive.cpp \
+	Renderer/RoutineCompiler.cpp \
 	Renderer/Sampler.cpp \
 	Renderer/SetupProcessor.cpp \
 	Renderer/Surface.cpp \
 	Renderer/TextureStage.cpp \
+	Renderer/ThreadPool.cpp \
 	Renderer/Vector.cpp \
 	Renderer/VertexProcessor.cpp \
 
 COMMON_SRC_FILES += \
+	Shader/ClipRoutine.cpp \
 	Shader/Constants.cpp \
 	Shader/PixelPipeline.cpp \
 	Shader/PixelProgram.cpp \
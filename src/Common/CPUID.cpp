@@ -24,6 +24,7 @@
 #else
 	#include <unistd.h>
 	#include <sched.h>
+	#include <stdio.h>
 	#include <sys/types.h>
 #endif
 
@@ -256,6 +257,76 @@ namespace sw
 		return cores;   // FIXME: Number of physical cores
 	}
 
+	std::vector<int> CPUID::affinityCPUs()
+	{
+		std::vector<int> cpus;
+
+		#if defined(_WIN32)
+			DWORD_PTR processAffinityMask = 1;
+			DWORD_PTR systemAffinityMask = 1;
+
+			GetProcessAffinityMask(GetCurrentProcess(), &processAffinityMask, &systemAffinityMask);
+
+			for(int cpu = 0; cpu < (int)sizeof(DWORD_PTR) * 8; cpu++)
+			{
+				if(processAffinityMask & ((DWORD_PTR)1 << cpu))
+				{
+					cpus.push_back(cpu);
+				}
+			}
+		#elif defined(__linux__)
+			cpu_set_t set;
+			CPU_ZERO(&set);
+
+			if(sched_getaffinity(0, sizeof(set), &set) == 0)
+			{
+				for(int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+				{
+					if(CPU_ISSET(cpu, &set))
+					{
+						cpus.push_back(cpu);
+					}
+				}
+			}
+		#endif
+
+		if(cpus.empty())
+		{
+			for(int cpu = 0; cpu < cores; cpu++)
+			{
+				cpus.push_back(cpu);
+			}
+		}
+
+		return cpus;
+	}
+
+	int CPUID::numaNode(int cpu)
+	{
+		#if defined(_WIN32)
+			UCHAR node = 0;
+
+			if(cpu < 64 && GetNumaProcessorNode((UCHAR)cpu, &node) && node != 0xFF)
+			{
+				return node;
+			}
+		#elif defined(__linux__)
+			// sysfs links each CPU to its node as cpu<N>/node<M>
+			for(int node = 0; node < 64; node++)
+			{
+				char path[64];
+				snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/node%d", cpu, node);
+
+				if(access(path, F_OK) == 0)
+				{
+					return node;
+				}
+			}
+		#endif
+
+		return 0;
+	}
+
 	int CPUID::detectAffinity()
 	{
 		int cores = 0;
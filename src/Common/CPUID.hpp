@@ -15,6 +15,8 @@
 #ifndef sw_CPUID_hpp
 #define sw_CPUID_hpp
 
+#include <vector>
+
 namespace sw
 {
 	#if !defined(__i386__) && defined(_M_IX86)
@@ -38,6 +40,8 @@ namespace sw
 		static bool supportsSSE4_1();
 		static int coreCount();
 		static int processAffinity();
+		static std::vector<int> affinityCPUs();   // Logical CPUs the process may run on, in ascending order
+		static int numaNode(int cpu);             // NUMA node of a logical CPU, 0 when unknown
 
 		static void setEnableMMX(bool enable);
 		static void setEnableCMOV(bool enable);
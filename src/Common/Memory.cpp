@@ -30,6 +30,11 @@
 	#include <unistd.h>
 #endif
 
+#if defined(__linux__)
+	#include <sys/syscall.h>
+#endif
+
+#include <atomic>
 #include <memory.h>
 
 #undef allocate
@@ -43,6 +48,8 @@ namespace sw
 {
 namespace
 {
+std::atomic<uint64_t> interleaveNodes(0);   // NUMA nodes allocateInterleaved() spreads pages over, 0 for first touch
+
 struct Allocation
 {
 //	size_t bytes;
@@ -146,6 +153,11 @@ size_t memoryPageSize()
 	return pageSize;
 }
 
+void setInterleaveNodes(uint64_t nodeMask)
+{
+	interleaveNodes.store(nodeMask, std::memory_order_relaxed);
+}
+
 void *allocate(size_t bytes, size_t alignment)
 {
 	void *memory = allocateRaw(bytes, alignment);
@@ -158,6 +170,35 @@ void *allocate(size_t bytes, size_t alignment)
 	return memory;
 }
 
+void *allocateInterleaved(size_t bytes, size_t alignment)
+{
+	void *memory = allocateRaw(bytes, alignment);
+
+	if(memory)
+	{
+		#if defined(__linux__) && defined(SYS_mbind)
+			// Pages get placed when the memset below first touches them, which would put
+			// them all on the calling thread's node while every rendering thread reads them
+			uint64_t nodeMask = interleaveNodes.load(std::memory_order_relaxed);
+
+			if(nodeMask && bytes >= 64 * memoryPageSize())
+			{
+				const int MPOL_INTERLEAVE = 3;
+				uintptr_t pageMask = memoryPageSize() - 1;
+				uintptr_t begin = ((uintptr_t)memory + pageMask) & ~pageMask;
+				uintptr_t end = ((uintptr_t)memory + bytes) & ~pageMask;
+				unsigned long nodes = (unsigned long)nodeMask;
+
+				syscall(SYS_mbind, begin, end - begin, MPOL_INTERLEAVE, &nodes, sizeof(nodes) * 8, 0);
+			}
+		#endif
+
+		memset(memory, 0, bytes);
+	}
+
+	return memory;
+}
+
 void deallocate(void *memory)
 {
 	#if defined(LINUX_ENABLE_NAMED_MMAP)
@@ -25,6 +25,9 @@ size_t memoryPageSize();
 void *allocate(size_t bytes, size_t alignment = 16);
 void deallocate(void *memory);
 
+void *allocateInterleaved(size_t bytes, size_t alignment = 16);   // Like allocate(), but large allocations get their pages spread over the nodes set below
+void setInterleaveNodes(uint64_t nodeMask);   // NUMA nodes for allocateInterleaved(), 0 to place pages on first touch
+
 void *allocateExecutable(size_t bytes);   // Allocates memory that can be made executable using markExecutable()
 void markExecutable(void *memory, size_t bytes);
 void deallocateExecutable(void *memory, size_t bytes);
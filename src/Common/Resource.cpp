@@ -156,6 +156,17 @@ namespace sw
 		criticalSection.unlock();
 	}
 
+	bool Resource::isBusy()
+	{
+		criticalSection.lock();
+
+		bool busy = count > 0 && accessor != PUBLIC;
+
+		criticalSection.unlock();
+
+		return busy;
+	}
+
 	void Resource::destruct()
 	{
 		criticalSection.lock();
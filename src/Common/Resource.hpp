@@ -39,6 +39,8 @@ namespace sw
 		void unlock();
 		void unlock(Accessor relinquisher);
 
+		bool isBusy();   // Locked by the renderer, so a PUBLIC lock would block
+
 		const void *data() const;
 		const size_t size;
 
@@ -50,6 +50,38 @@ namespace sw
 		}
 	}
 
+	bool Thread::setAffinity(const std::vector<int> &cpus)
+	{
+		#if defined(_WIN32)
+			DWORD_PTR mask = 0;
+
+			for(int cpu : cpus)
+			{
+				if(cpu >= 0 && cpu < (int)sizeof(DWORD_PTR) * 8)
+				{
+					mask |= (DWORD_PTR)1 << cpu;
+				}
+			}
+
+			return mask && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+		#elif defined(__linux__)
+			cpu_set_t set;
+			CPU_ZERO(&set);
+
+			for(int cpu : cpus)
+			{
+				if(cpu >= 0 && cpu < CPU_SETSIZE)
+				{
+					CPU_SET(cpu, &set);
+				}
+			}
+
+			return CPU_COUNT(&set) && sched_setaffinity(0, sizeof(set), &set) == 0;
+		#else
+			return false;   // Placement is left to the OS
+		#endif
+	}
+
 	#if defined(_WIN32)
 		unsigned long __stdcall Thread::startFunction(void *parameters)
 		{
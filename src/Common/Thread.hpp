@@ -29,6 +29,7 @@
 #endif
 
 #include <stdlib.h>
+#include <vector>
 
 #if defined(__clang__)
 #if __has_include(<atomic>) // clang has an explicit check for the availability of atomic
@@ -58,6 +59,7 @@ namespace sw
 
 		static void yield();
 		static void sleep(int milliseconds);
+		static bool setAffinity(const std::vector<int> &cpus);   // Restricts the calling thread to the given logical CPUs
 
 		#if defined(_WIN32)
 			typedef DWORD LocalStorageKey;
@@ -120,6 +122,7 @@ namespace sw
 	int atomicIncrement(int volatile *value);
 	int atomicDecrement(int volatile *value);
 	int atomicAdd(int volatile *target, int value);
+	int atomicCompareExchange(int volatile *target, int exchange, int comparand);
 	void nop();
 }
 
@@ -285,6 +288,15 @@ namespace sw
 		#endif
 	}
 
+	inline int atomicCompareExchange(volatile int *target, int exchange, int comparand)
+	{
+		#if defined(_WIN32)
+			return InterlockedCompareExchange((volatile long*)target, (long)exchange, (long)comparand);
+		#else
+			return __sync_val_compare_and_swap(target, comparand, exchange);
+		#endif
+	}
+
 	inline void nop()
 	{
 		#if defined(_WIN32)
@@ -310,6 +322,7 @@ namespace sw
 			inline int operator++(int) { return ai.fetch_add(1, std::memory_order_acq_rel) + 1; }
 			inline void operator-=(int i) { ai.fetch_sub(i, std::memory_order_acq_rel); }
 			inline void operator+=(int i) { ai.fetch_add(i, std::memory_order_acq_rel); }
+			inline bool compareExchange(int expected, int desired) { return ai.compare_exchange_strong(expected, desired, std::memory_order_acq_rel); }
 		private:
 			std::atomic<int> ai;
 		};
@@ -329,6 +342,7 @@ namespace sw
 			inline int operator++(int) { return sw::atomicIncrement(&vi); }
 			inline void operator-=(int i) { sw::atomicAdd(&vi, -i); }
 			inline void operator+=(int i) { sw::atomicAdd(&vi, i); }
+			inline bool compareExchange(int expected, int desired) { return sw::atomicCompareExchange(&vi, desired, expected) == expected; }
 		private:
 			volatile int vi;
 		};
@@ -0,0 +1,126 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef sw_WorkStealingQueue_hpp
+#define sw_WorkStealingQueue_hpp
+
+#include "Thread.hpp"
+
+namespace sw
+{
+	// Bounded single-producer, multiple-consumer ring buffer. Each worker thread
+	// owns one queue into which it publishes the tasks it discovered, and any
+	// thread (including the owner) can take entries from it. Idle threads first
+	// drain their own queue and then steal from the others.
+	//
+	// Each slot carries a sequence number which tells whether it holds an entry
+	// for the current lap or is free to be written, so an entry is only copied
+	// out after the consumer claimed it, and the producer never overwrites a slot
+	// that is still being read. No locks are needed to distribute work.
+	template<class T, int N>
+	class WorkStealingQueue
+	{
+		static_assert((N & (N - 1)) == 0, "N must be a power of 2");
+
+	public:
+		WorkStealingQueue() : head(0), tail(0)
+		{
+			for(int i = 0; i < N; i++)
+			{
+				ring[i].sequence = i;
+			}
+		}
+
+		bool push(const T &entry)
+		{
+			int t = tail;
+			Slot &slot = ring[t & (N - 1)];
+
+			if(slot.sequence != t)
+			{
+				return false;   // Full, or the previous entry is still being read
+			}
+
+			slot.entry = entry;
+			slot.sequence = t + 1;   // Publish the entry
+			tail = t + 1;
+
+			return true;
+		}
+
+		bool take(T &entry)
+		{
+			while(true)
+			{
+				int h = head;
+				Slot &slot = ring[h & (N - 1)];
+				int ahead = distance(h + 1, slot.sequence);
+
+				if(ahead < 0)
+				{
+					return false;   // Empty
+				}
+
+				if(ahead == 0 && head.compareExchange(h, h + 1))
+				{
+					entry = slot.entry;
+					slot.sequence = h + N;   // Free for the producer's next lap
+
+					return true;
+				}
+			}
+		}
+
+		// Only meaningful to the producer, since no other thread can make room unavailable
+		bool full() const
+		{
+			int t = tail;
+
+			return ring[t & (N - 1)].sequence != t;
+		}
+
+		bool empty() const
+		{
+			return distance(head, tail) <= 0;
+		}
+
+		int size() const
+		{
+			int size = distance(head, tail);
+
+			return size > 0 ? size : 0;
+		}
+
+	private:
+		static int distance(int from, int to)
+		{
+			return (int)((unsigned int)to - (unsigned int)from);   // Wrap-around safe
+		}
+
+		struct Slot
+		{
+			AtomicInt sequence;
+			T entry;
+		};
+
+		Slot ring[N];
+
+		// Keep the consumer and producer indices on separate cache lines
+		AtomicInt head;
+		volatile int padding[15];
+		AtomicInt tail;
+	};
+}
+
+#endif   // sw_WorkStealingQueue_hpp
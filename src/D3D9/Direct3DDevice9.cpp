@@ -1049,7 +1049,7 @@ namespace D3D9
 			for(int instance = 0; instance < instanceCount; instance++)
 			{
 				bindVertexStreams(baseVertexIndex, true, instance);
-				renderer->draw(drawType, indexOffset, primitiveCount, instance == 0);
+				renderer->draw(drawType, indexOffset, primitiveCount, 1, instance == 0);
 			}
 		}
 		else
@@ -38,6 +38,10 @@ namespace sw
 				cycles[i] = 0;
 			}
 
+			vertexCacheHits = 0;
+			vertexCacheMisses = 0;
+			vertexCacheHitRate = 0;
+
 			ropOperations = 0;
 			ropOperationsTotal = 0;
 			ropOperationsFrame = 0;
@@ -62,6 +66,14 @@ namespace sw
 			ropOperationsTotal += ropOperationsFrame;
 			texOperationsTotal += texOperationsFrame;
 			compressedTexTotal += compressedTexFrame;
+
+			int64_t hits = sw::atomicExchange(&vertexCacheHits, 0);
+			int64_t misses = sw::atomicExchange(&vertexCacheMisses, 0);
+
+			if(hits + misses > 0)
+			{
+				vertexCacheHitRate = (double)hits / (hits + misses);
+			}
 		#endif
 
 		static double fpsTime = sw::Timer::seconds();
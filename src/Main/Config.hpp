@@ -57,6 +57,10 @@ namespace sw
 		#if PERF_PROFILE
 		double cycles[PERF_TIMERS];
 
+		int64_t vertexCacheHits;
+		int64_t vertexCacheMisses;
+		double vertexCacheHitRate;   // Of the last frame
+
 		int64_t ropOperations;
 		int64_t ropOperationsTotal;
 		int64_t ropOperationsFrame;
@@ -76,6 +80,8 @@ namespace sw
 	enum
 	{
 		OUTLINE_RESOLUTION = 8192,   // Maximum vertical resolution of the render target
+		TILE_SHIFT = 6,              // Screen tiles are 64x64 pixels
+		TILE_SIZE = 1 << TILE_SHIFT,
 		MIPMAP_LEVELS = 14,
 		TEXTURE_IMAGE_UNITS = 16,
 		VERTEX_TEXTURE_IMAGE_UNITS = 16,
@@ -335,7 +335,18 @@ namespace sw
 		html += "</select></td>\n";
 		html += "</tr>\n";
 		html += "<tr><td>Vertex cache size:</td><td><select name='vertexCacheSize' title='The number of processed vertices being cached for reuse. Lower numbers save memory but require more vertices to be reprocessed.'>\n";
+		html += "<option value='16'"   + (config.vertexCacheSize == 16   ? selected : empty) + ">16</option>\n";
+		html += "<option value='32'"   + (config.vertexCacheSize == 32   ? selected : empty) + ">32</option>\n";
 		html += "<option value='64'"   + (config.vertexCacheSize == 64   ? selected : empty) + ">64 (default)</option>\n";
+		html += "<option value='128'"  + (config.vertexCacheSize == 128  ? selected : empty) + ">128</option>\n";
+		html += "<option value='256'"  + (config.vertexCacheSize == 256  ? selected : empty) + ">256</option>\n";
+		html += "</select></td>\n";
+		html += "</tr>\n";
+		html += "<tr><td>Vertex cache associativity:</td><td><select name='vertexCacheAssociativity' title='The number of cache lines of four vertices which a vertex can be stored in. Higher numbers avoid reprocessing vertices which are reused far apart, at a higher lookup cost.'>\n";
+		html += "<option value='1'"    + (config.vertexCacheAssociativity == 1 ? selected : empty) + ">Direct mapped (default)</option>\n";
+		html += "<option value='2'"    + (config.vertexCacheAssociativity == 2 ? selected : empty) + ">2-way</option>\n";
+		html += "<option value='4'"    + (config.vertexCacheAssociativity == 4 ? selected : empty) + ">4-way</option>\n";
+		html += "<option value='8'"    + (config.vertexCacheAssociativity == 8 ? selected : empty) + ">8-way</option>\n";
 		html += "</select></td>\n";
 		html += "</tr>\n";
 		html += "</table>\n";
@@ -392,11 +403,27 @@ namespace sw
 		html += "<option value='15'" + (config.threadCount == 15 ? selected : empty) + ">15</option>\n";
 		html += "<option value='16'" + (config.threadCount == 16 ? selected : empty) + ">16</option>\n";
 		html += "</select></td></tr>\n";
+		html += "<tr><td>Thread affinity:</td><td><select name='threadAffinity' title='How the rendering threads get pinned to CPU cores. Compact fills up one NUMA node before using the next, scatter spreads the threads over all nodes. An explicit list of CPUs can be set with ThreadAffinityCPUs in the configuration file.'>\n";
+		html += "<option value='0'" + (config.threadAffinity == 0 ? selected : empty) + ">None (default)</option>\n";
+		html += "<option value='1'" + (config.threadAffinity == 1 ? selected : empty) + ">Compact</option>\n";
+		html += "<option value='2'" + (config.threadAffinity == 2 ? selected : empty) + ">Scatter</option>\n";
+		html += "</select></td></tr>\n";
 		html += "<tr><td>Enable SSE:</td><td><input name = 'enableSSE' type='checkbox'" + (config.enableSSE ? checked : empty) + " disabled='disabled' title='If checked enables the use of SSE instruction set extentions if supported by the CPU.'></td></tr>";
 		html += "<tr><td>Enable SSE2:</td><td><input name = 'enableSSE2' type='checkbox'" + (config.enableSSE2 ? checked : empty) + " title='If checked enables the use of SSE2 instruction set extentions if supported by the CPU.'></td></tr>";
 		html += "<tr><td>Enable SSE3:</td><td><input name = 'enableSSE3' type='checkbox'" + (config.enableSSE3 ? checked : empty) + " title='If checked enables the use of SSE3 instruction set extentions if supported by the CPU.'></td></tr>";
 		html += "<tr><td>Enable SSSE3:</td><td><input name = 'enableSSSE3' type='checkbox'" + (config.enableSSSE3 ? checked : empty) + " title='If checked enables the use of SSSE3 instruction set extentions if supported by the CPU.'></td></tr>";
 		html += "<tr><td>Enable SSE4.1:</td><td><input name = 'enableSSE4_1' type='checkbox'" + (config.enableSSE4_1 ? checked : empty) + " title='If checked enables the use of SSE4.1 instruction set extentions if supported by the CPU.'></td></tr>";
+		html += "<tr><td>Tile rasterization:</td><td><input name = 'tileRasterization' type='checkbox'" + (config.tileRasterization ? checked : empty) + " title='If checked each thread renders whole screen tiles instead of interleaved scanlines.'></td></tr>";
+		html += "<tr><td>Position-only culling:</td><td><input name = 'positionOnlyCulling' type='checkbox'" + (config.positionOnlyCulling ? checked : empty) + " title='If checked triangles which get culled are determined using only their vertex positions, before computing the other vertex outputs.'></td></tr>";
+		html += "<tr><td>Guard-band clipping:</td><td><input name = 'guardBandClipping' type='checkbox'" + (config.guardBandClipping ? checked : empty) + " title='If checked triangles which cross the sides of the viewport only get clipped when they extend beyond a larger guard band, and are scissored otherwise.'></td></tr>";
+		html += "<tr><td>Routine tier-up threshold:</td><td><select name='tierUpThreshold' title='The number of draw calls which use a quickly compiled routine before it gets recompiled with full optimization in the background. Only used with asynchronous routine compilation and the LLVM back-end. Disabling it compiles every routine with full optimization right away.'>\n";
+		html += "<option value='0'"   + (config.tierUpThreshold == 0   ? selected : empty) + ">Disabled</option>\n";
+		html += "<option value='4'"   + (config.tierUpThreshold == 4   ? selected : empty) + ">4</option>\n";
+		html += "<option value='16'"  + (config.tierUpThreshold == 16  ? selected : empty) + ">16 (default)</option>\n";
+		html += "<option value='64'"  + (config.tierUpThreshold == 64  ? selected : empty) + ">64</option>\n";
+		html += "<option value='256'" + (config.tierUpThreshold == 256 ? selected : empty) + ">256</option>\n";
+		html += "</select></td></tr>\n";
+		html += "<tr><td>Asynchronous routine compilation:</td><td><input name = 'asyncRoutineCompilation' type='checkbox'" + (config.asyncRoutineCompilation ? checked : empty) + " title='If checked new routines are compiled on background threads, and draw calls wait for them without blocking the application.'></td></tr>";
 		html += "</table>\n";
 		html += "<h2><em>Compiler optimizations</em></h2>\n";
 		html += "<table>\n";
@@ -431,7 +458,7 @@ namespace sw
 		html += "<option value='0'" + (config.frameBufferAPI == 0 ? selected : empty) + ">DirectDraw (default)</option>\n";
 		html += "<option value='1'" + (config.frameBufferAPI == 1 ? selected : empty) + ">GDI</option>\n";
 		html += "</select></td>\n";
-		html += "<tr><td>DLL precaching:</td><td><input name = 'precache' type='checkbox'" + (config.precache == true ? checked : empty) + " title='If checked dynamically generated routines will be stored in a DLL for faster loading on application restart.'></td></tr>";
+		html += "<tr><td>Routine precaching:</td><td><input name = 'precache' type='checkbox'" + (config.precache == true ? checked : empty) + " title='If checked dynamically generated routines will be stored in an on-disk cache for faster loading on application restart. The cache directory must be set with PrecacheDirectory in the configuration file. Requires the Subzero back-end.'></td></tr>";
 		html += "<tr><td>Shadow mapping extensions:</td><td><select name='shadowMapping' title='Features that may accelerate or improve the quality of shadow mapping.'>\n";
 		html += "<option value='0'" + (config.shadowMapping == 0 ? selected : empty) + ">None</option>\n";
 		html += "<option value='1'" + (config.shadowMapping == 1 ? selected : empty) + ">Fetch4</option>\n";
@@ -468,6 +495,8 @@ namespace sw
 		html += "<p>Frame: " + itoa(profiler.framesTotal) + "</p>\n";
 
 		#if PERF_PROFILE
+			html += "<p>Vertex cache hit rate: " + ftoa(100 * profiler.vertexCacheHitRate) + "%</p>\n";
+
 			int texTime = (int)(1000 * profiler.cycles[PERF_TEX] / profiler.cycles[PERF_PIXEL] + 0.5);
 			int shaderTime = (int)(1000 * profiler.cycles[PERF_SHADER] / profiler.cycles[PERF_PIXEL] + 0.5);
 			int pipeTime = (int)(1000 * profiler.cycles[PERF_PIPE] / profiler.cycles[PERF_PIXEL] + 0.5);
@@ -539,6 +568,10 @@ namespace sw
 		config.enableSSE3 = false;
 		config.enableSSSE3 = false;
 		config.enableSSE4_1 = false;
+		config.tileRasterization = false;
+		config.positionOnlyCulling = false;
+		config.guardBandClipping = false;
+		config.asyncRoutineCompilation = false;
 		config.disableServer = false;
 		config.forceWindowed = false;
 		config.complementaryDepthBuffer = false;
@@ -582,10 +615,18 @@ namespace sw
 			{
 				config.setupRoutineCacheSize = integer;
 			}
+			else if(sscanf(post, "tierUpThreshold=%d", &integer))
+			{
+				config.tierUpThreshold = integer;
+			}
 			else if(sscanf(post, "vertexCacheSize=%d", &integer))
 			{
 				config.vertexCacheSize = integer;
 			}
+			else if(sscanf(post, "vertexCacheAssociativity=%d", &integer))
+			{
+				config.vertexCacheAssociativity = integer;
+			}
 			else if(sscanf(post, "textureSampleQuality=%d", &integer))
 			{
 				config.textureSampleQuality = integer;
@@ -610,6 +651,10 @@ namespace sw
 			{
 				config.threadCount = integer;
 			}
+			else if(sscanf(post, "threadAffinity=%d", &integer))
+			{
+				config.threadAffinity = integer;
+			}
 			else if(sscanf(post, "frameBufferAPI=%d", &integer))
 			{
 				config.frameBufferAPI = integer;
@@ -650,6 +695,22 @@ namespace sw
 					config.enableSSE4_1 = true;
 				}
 			}
+			else if(strstr(post, "tileRasterization=on"))
+			{
+				config.tileRasterization = true;
+			}
+			else if(strstr(post, "positionOnlyCulling=on"))
+			{
+				config.positionOnlyCulling = true;
+			}
+			else if(strstr(post, "guardBandClipping=on"))
+			{
+				config.guardBandClipping = true;
+			}
+			else if(strstr(post, "asyncRoutineCompilation=on"))
+			{
+				config.asyncRoutineCompilation = true;
+			}
 			else if(sscanf(post, "optimization%d=%d", &index, &integer))
 			{
 				config.optimization[index - 1] = (Optimization)integer;
@@ -725,17 +786,25 @@ namespace sw
 		config.pixelRoutineCacheSize = ini.getInteger("Caches", "PixelRoutineCacheSize", 1024);
 		config.setupRoutineCacheSize = ini.getInteger("Caches", "SetupRoutineCacheSize", 1024);
 		config.vertexCacheSize = ini.getInteger("Caches", "VertexCacheSize", 64);
+		config.vertexCacheAssociativity = ini.getInteger("Caches", "VertexCacheAssociativity", 1);
 		config.textureSampleQuality = ini.getInteger("Quality", "TextureSampleQuality", 2);
 		config.mipmapQuality = ini.getInteger("Quality", "MipmapQuality", 1);
 		config.perspectiveCorrection = ini.getBoolean("Quality", "PerspectiveCorrection", true);
 		config.transcendentalPrecision = ini.getInteger("Quality", "TranscendentalPrecision", 2);
 		config.transparencyAntialiasing = ini.getInteger("Quality", "TransparencyAntialiasing", 0);
 		config.threadCount = ini.getInteger("Processor", "ThreadCount", DEFAULT_THREAD_COUNT);
+		config.threadAffinity = ini.getInteger("Processor", "ThreadAffinity", 0);
+		config.threadAffinityCPUs = ini.getValue("Processor", "ThreadAffinityCPUs");
 		config.enableSSE = ini.getBoolean("Processor", "EnableSSE", true);
 		config.enableSSE2 = ini.getBoolean("Processor", "EnableSSE2", true);
 		config.enableSSE3 = ini.getBoolean("Processor", "EnableSSE3", true);
 		config.enableSSSE3 = ini.getBoolean("Processor", "EnableSSSE3", true);
 		config.enableSSE4_1 = ini.getBoolean("Processor", "EnableSSE4_1", true);
+		config.tileRasterization = ini.getBoolean("Processor", "TileRasterization", false);
+		config.positionOnlyCulling = ini.getBoolean("Processor", "PositionOnlyCulling", true);
+		config.guardBandClipping = ini.getBoolean("Processor", "GuardBandClipping", true);
+		config.asyncRoutineCompilation = ini.getBoolean("Processor", "AsyncRoutineCompilation", false);
+		config.tierUpThreshold = ini.getInteger("Processor", "TierUpThreshold", 16);
 
 		for(int pass = 0; pass < 10; pass++)
 		{
@@ -751,6 +820,7 @@ namespace sw
 		config.disable10BitMode = ini.getBoolean("Testing", "Disable10BitMode", false);
 		config.frameBufferAPI = ini.getInteger("Testing", "FrameBufferAPI", 0);
 		config.precache = ini.getBoolean("Testing", "Precache", false);
+		config.precacheDirectory = ini.getValue("Testing", "PrecacheDirectory");
 		config.shadowMapping = ini.getInteger("Testing", "ShadowMapping", 3);
 		config.forceClearRegisters = ini.getBoolean("Testing", "ForceClearRegisters", false);
 
@@ -783,17 +853,29 @@ namespace sw
 		ini.addValue("Caches", "PixelRoutineCacheSize", itoa(config.pixelRoutineCacheSize));
 		ini.addValue("Caches", "SetupRoutineCacheSize", itoa(config.setupRoutineCacheSize));
 		ini.addValue("Caches", "VertexCacheSize", itoa(config.vertexCacheSize));
+		ini.addValue("Caches", "VertexCacheAssociativity", itoa(config.vertexCacheAssociativity));
 		ini.addValue("Quality", "TextureSampleQuality", itoa(config.textureSampleQuality));
 		ini.addValue("Quality", "MipmapQuality", itoa(config.mipmapQuality));
 		ini.addValue("Quality", "PerspectiveCorrection", itoa(config.perspectiveCorrection));
 		ini.addValue("Quality", "TranscendentalPrecision", itoa(config.transcendentalPrecision));
 		ini.addValue("Quality", "TransparencyAntialiasing", itoa(config.transparencyAntialiasing));
 		ini.addValue("Processor", "ThreadCount", itoa(config.threadCount));
+		ini.addValue("Processor", "ThreadAffinity", itoa(config.threadAffinity));
+
+		if(!config.threadAffinityCPUs.empty())
+		{
+			ini.addValue("Processor", "ThreadAffinityCPUs", config.threadAffinityCPUs);
+		}
 	//	ini.addValue("Processor", "EnableSSE", itoa(config.enableSSE));
 		ini.addValue("Processor", "EnableSSE2", itoa(config.enableSSE2));
 		ini.addValue("Processor", "EnableSSE3", itoa(config.enableSSE3));
 		ini.addValue("Processor", "EnableSSSE3", itoa(config.enableSSSE3));
 		ini.addValue("Processor", "EnableSSE4_1", itoa(config.enableSSE4_1));
+		ini.addValue("Processor", "TileRasterization", itoa(config.tileRasterization));
+		ini.addValue("Processor", "PositionOnlyCulling", itoa(config.positionOnlyCulling));
+		ini.addValue("Processor", "GuardBandClipping", itoa(config.guardBandClipping));
+		ini.addValue("Processor", "AsyncRoutineCompilation", itoa(config.asyncRoutineCompilation));
+		ini.addValue("Processor", "TierUpThreshold", itoa(config.tierUpThreshold));
 
 		for(int pass = 0; pass < 10; pass++)
 		{
@@ -809,6 +891,12 @@ namespace sw
 		ini.addValue("Testing", "Disable10BitMode", itoa(config.disable10BitMode));
 		ini.addValue("Testing", "FrameBufferAPI", itoa(config.frameBufferAPI));
 		ini.addValue("Testing", "Precache", itoa(config.precache));
+
+		if(!config.precacheDirectory.empty())
+		{
+			ini.addValue("Testing", "PrecacheDirectory", config.precacheDirectory);
+		}
+
 		ini.addValue("Testing", "ShadowMapping", itoa(config.shadowMapping));
 		ini.addValue("Testing", "ForceClearRegisters", itoa(config.forceClearRegisters));
 		ini.addValue("LastModified", "Time", itoa((int)time(0)));
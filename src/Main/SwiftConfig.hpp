@@ -38,16 +38,24 @@ namespace sw
 			int pixelRoutineCacheSize;
 			int setupRoutineCacheSize;
 			int vertexCacheSize;
+			int vertexCacheAssociativity;
 			int textureSampleQuality;
 			int mipmapQuality;
 			bool perspectiveCorrection;
 			int transcendentalPrecision;
 			int threadCount;
+			int threadAffinity;
+			std::string threadAffinityCPUs;
 			bool enableSSE;
 			bool enableSSE2;
 			bool enableSSE3;
 			bool enableSSSE3;
 			bool enableSSE4_1;
+			bool tileRasterization;
+			bool positionOnlyCulling;
+			bool guardBandClipping;
+			bool asyncRoutineCompilation;
+			int tierUpThreshold;
 			Optimization optimization[10];
 			bool disableServer;
 			bool keepSystemCursor;
@@ -60,6 +68,7 @@ namespace sw
 			int transparencyAntialiasing;
 			int frameBufferAPI;
 			bool precache;
+			std::string precacheDirectory;
 			int shadowMapping;
 			bool forceClearRegisters;
 		#ifndef NDEBUG
@@ -202,6 +202,7 @@ GLenum VertexDataManager::prepareVertexData(GLint start, GLsizei count, Translat
 			translated[i].count = 4;
 			translated[i].stride = 0;
 			translated[i].offset = 0;
+			translated[i].normalized = false;
 		}
 	}
 
@@ -25,9 +25,15 @@
 namespace es2
 {
 
+static const int padding = 1024;   // For SIMD processing of vertices
+static const size_t maxRetiredContents = 4;
+static const size_t maxIndexRanges = 64;
+static const size_t maxPreservingRenameSize = 64 * 1024;   // Larger buffers only get renamed when most of them gets overwritten
+
 Buffer::Buffer(GLuint name) : NamedObject(name)
 {
 	mContents = 0;
+	mTransformFeedbackTarget = false;
 	mSize = 0;
 	mUsage = GL_STATIC_DRAW;
 	mIsMapped = false;
@@ -42,22 +48,46 @@ Buffer::~Buffer()
 	{
 		mContents->destruct();
 	}
+
+	clearRetiredContents();
 }
 
 void Buffer::bufferData(const void *data, GLsizeiptr size, GLenum usage)
 {
+	mUsage = usage;
+	mIndexRanges.clear();
+
+	// Respecifying the contents with the same size orphans the previous storage instead of
+	// reallocating it, so streaming geometry doesn't wait for the draws still using it
+	if(mContents && size == (GLsizeiptr)mSize)
+	{
+		if(mContents->isBusy())
+		{
+			renameContents(false);
+		}
+
+		if(data)
+		{
+			char *buffer = (char*)mContents->lock(sw::PUBLIC);
+			memcpy(buffer, data, size);
+			mContents->unlock();
+		}
+
+		return;
+	}
+
 	if(mContents)
 	{
 		mContents->destruct();
 		mContents = 0;
 	}
 
+	clearRetiredContents();
+
 	mSize = size;
-	mUsage = usage;
 
 	if(size > 0)
 	{
-		const int padding = 1024;   // For SIMD processing of vertices
 		mContents = new sw::Resource(size + padding);
 
 		if(!mContents)
@@ -77,7 +107,14 @@ void Buffer::bufferSubData(const void *data, GLsizeiptr size, GLintptr offset)
 {
 	if(mContents && data)
 	{
-		char *buffer = (char*)mContents->lock(sw::PUBLIC);
+		mIndexRanges.clear();
+
+		if(mContents->isBusy() && worthRenaming(size))
+		{
+			renameContents(offset != 0 || size != (GLsizeiptr)mSize);
+		}
+
+		char *buffer = (char*)mContents->lock(sw::PUBLIC);   // Waits for pending draws when not renamed
 		memcpy(buffer + offset, data, size);
 		mContents->unlock();
 	}
@@ -87,7 +124,30 @@ void* Buffer::mapRange(GLintptr offset, GLsizeiptr length, GLbitfield access)
 {
 	if(mContents)
 	{
-		char* buffer = (char*)mContents->lock(sw::PUBLIC);
+		char *buffer = nullptr;
+
+		if(access & GL_MAP_WRITE_BIT)
+		{
+			mIndexRanges.clear();
+		}
+
+		if(access & GL_MAP_UNSYNCHRONIZED_BIT)
+		{
+			// The application guarantees it doesn't modify data used by pending draws
+			buffer = (char*)mContents->data();
+		}
+		else
+		{
+			bool rename = (access & GL_MAP_INVALIDATE_BUFFER_BIT) || ((access & GL_MAP_INVALIDATE_RANGE_BIT) && worthRenaming(length));
+
+			if(rename && mContents->isBusy())
+			{
+				renameContents(!(access & GL_MAP_INVALIDATE_BUFFER_BIT));
+			}
+
+			buffer = (char*)mContents->lock(sw::PUBLIC);
+		}
+
 		mIsMapped = true;
 		mOffset = offset;
 		mLength = length;
@@ -99,10 +159,14 @@ void* Buffer::mapRange(GLintptr offset, GLsizeiptr length, GLbitfield access)
 
 bool Buffer::unmap()
 {
-	if(mContents)
+	if(mContents && !(mAccess & GL_MAP_UNSYNCHRONIZED_BIT))
 	{
 		mContents->unlock();
 	}
+	if(mAccess & GL_MAP_WRITE_BIT)
+	{
+		mIndexRanges.clear();   // Draws issued while mapped may have cached ranges of the old contents
+	}
 	mIsMapped = false;
 	mOffset = 0;
 	mLength = 0;
@@ -115,4 +179,89 @@ sw::Resource *Buffer::getResource()
 	return mContents;
 }
 
+const IndexRange *Buffer::getIndexRange(GLenum type, GLintptr offset, GLsizei count, bool primitiveRestart) const
+{
+	auto range = mIndexRanges.find(IndexRangeKey(type, offset, count, primitiveRestart));
+
+	return (range != mIndexRanges.end()) ? &range->second : nullptr;
+}
+
+void Buffer::setIndexRange(GLenum type, GLintptr offset, GLsizei count, bool primitiveRestart, const IndexRange &range)
+{
+	if(mTransformFeedbackTarget)
+	{
+		return;   // Draws may change the contents without notice
+	}
+
+	if(mIndexRanges.size() >= maxIndexRanges)
+	{
+		mIndexRanges.clear();
+	}
+
+	mIndexRanges[IndexRangeKey(type, offset, count, primitiveRestart)] = range;
+}
+
+// Renaming a buffer for a partial update copies all of its contents, which only
+// pays off over waiting for the pending draws when that copy is small or mostly
+// consists of data which gets written anyway.
+bool Buffer::worthRenaming(GLsizeiptr updateSize) const
+{
+	return mSize <= maxPreservingRenameSize || (size_t)updateSize >= mSize / 2;
+}
+
+void Buffer::clearRetiredContents()
+{
+	for(auto contents : mRetiredContents)
+	{
+		contents->destruct();
+	}
+
+	mRetiredContents.clear();
+}
+
+// Replaces the contents with storage which isn't in use by any draw, leaving the previous
+// storage to the draws still using it. 'preserve' copies the current contents over.
+void Buffer::renameContents(bool preserve)
+{
+	if(preserve && mTransformFeedbackTarget)
+	{
+		return;   // Pending draws may still write to it, so wait for them instead
+	}
+
+	sw::Resource *contents = nullptr;
+
+	for(auto retired = mRetiredContents.begin(); retired != mRetiredContents.end(); ++retired)
+	{
+		if(!(*retired)->isBusy())
+		{
+			contents = *retired;
+			mRetiredContents.erase(retired);
+			break;
+		}
+	}
+
+	if(!contents)
+	{
+		contents = new sw::Resource(mSize + padding);
+	}
+
+	if(preserve)
+	{
+		void *buffer = contents->lock(sw::PUBLIC);
+		memcpy(buffer, mContents->data(), mSize);   // Pending draws only read the previous storage
+		contents->unlock();
+	}
+
+	if(mRetiredContents.size() < maxRetiredContents)
+	{
+		mRetiredContents.push_back(mContents);
+	}
+	else
+	{
+		mContents->destruct();
+	}
+
+	mContents = contents;
+}
+
 }
@@ -25,10 +25,19 @@
 #include <GLES2/gl2.h>
 
 #include <cstddef>
+#include <map>
+#include <tuple>
 #include <vector>
 
 namespace es2
 {
+struct IndexRange
+{
+	GLuint minIndex;
+	GLuint maxIndex;
+	std::vector<GLsizei> restartIndices;   // Positions of the primitive restart indices, when enabled
+};
+
 class Buffer : public gl::NamedObject
 {
 public:
@@ -40,6 +49,7 @@ public:
 	void bufferSubData(const void *data, GLsizeiptr size, GLintptr offset);
 
 	const void *data() const { return mContents ? mContents->data() : 0; }
+	void *modifiableData() { mIndexRanges.clear(); return mContents ? (void*)mContents->data() : 0; }   // For writes bypassing bufferSubData() and mapRange()
 	size_t size() const { return mSize; }
 	GLenum usage() const { return mUsage; }
 	bool isMapped() const { return mIsMapped; }
@@ -53,8 +63,24 @@ public:
 
 	sw::Resource *getResource();
 
+	// Index ranges of previous draws sourcing their indices from this buffer, cleared when the contents change
+	const IndexRange *getIndexRange(GLenum type, GLintptr offset, GLsizei count, bool primitiveRestart) const;
+	void setIndexRange(GLenum type, GLintptr offset, GLsizei count, bool primitiveRestart, const IndexRange &range);
+
+	// Draws write to the contents through transform feedback, so they can't be copied to new storage while in use
+	void setTransformFeedbackTarget() { mTransformFeedbackTarget = true; mIndexRanges.clear(); }
+
 private:
+	bool worthRenaming(GLsizeiptr updateSize) const;
+	void clearRetiredContents();
+	void renameContents(bool preserve);
+
 	sw::Resource *mContents;
+	std::vector<sw::Resource*> mRetiredContents;   // Previous storage, reused once the draws using it have completed
+	bool mTransformFeedbackTarget;
+
+	typedef std::tuple<GLenum, GLintptr, GLsizei, bool> IndexRangeKey;
+	std::map<IndexRangeKey, IndexRange> mIndexRanges;
 	size_t mSize;
 	GLenum mUsage;
 	bool mIsMapped;
@@ -41,6 +41,7 @@
 #include <EGL/eglext.h>
 
 #include <algorithm>
+#include <climits>
 #include <string>
 
 namespace es2
@@ -329,6 +330,7 @@ void Context::markAllStateDirty()
 {
 	mAppliedProgramSerial = 0;
 
+	mCullStateDirty = true;
 	mDepthStateDirty = true;
 	mMaskStateDirty = true;
 	mBlendStateDirty = true;
@@ -359,7 +361,11 @@ void Context::setClearStencil(int stencil)
 
 void Context::setCullFaceEnabled(bool enabled)
 {
-	mState.cullFaceEnabled = enabled;
+	if(mState.cullFaceEnabled != enabled)
+	{
+		mState.cullFaceEnabled = enabled;
+		mCullStateDirty = true;
+	}
 }
 
 bool Context::isCullFaceEnabled() const
@@ -369,7 +375,11 @@ bool Context::isCullFaceEnabled() const
 
 void Context::setCullMode(GLenum mode)
 {
-   mState.cullMode = mode;
+	if(mState.cullMode != mode)
+	{
+		mState.cullMode = mode;
+		mCullStateDirty = true;
+	}
 }
 
 void Context::setFrontFace(GLenum front)
@@ -378,6 +388,7 @@ void Context::setFrontFace(GLenum front)
 	{
 		mState.frontFace = front;
 		mFrontFaceDirty = true;
+		mCullStateDirty = true;
 	}
 }
 
@@ -2804,10 +2815,7 @@ bool Context::applyRenderTarget()
 
 	if(program)
 	{
-		GLfloat nearFarDiff[3] = {zNear, zFar, zFar - zNear};
-		program->setUniform1fv(program->getUniformLocation("gl_DepthRange.near"), 1, &nearFarDiff[0]);
-		program->setUniform1fv(program->getUniformLocation("gl_DepthRange.far"), 1, &nearFarDiff[1]);
-		program->setUniform1fv(program->getUniformLocation("gl_DepthRange.diff"), 1, &nearFarDiff[2]);
+		program->applyDepthRange(zNear, zFar);
 	}
 
 	return true;
@@ -2818,13 +2826,18 @@ void Context::applyState(GLenum drawMode)
 {
 	Framebuffer *framebuffer = getDrawFramebuffer();
 
-	if(mState.cullFaceEnabled)
+	if(mCullStateDirty)
 	{
-		device->setCullMode(es2sw::ConvertCullMode(mState.cullMode, mState.frontFace));
-	}
-	else
-	{
-		device->setCullMode(sw::CULL_NONE);
+		if(mState.cullFaceEnabled)
+		{
+			device->setCullMode(es2sw::ConvertCullMode(mState.cullMode, mState.frontFace));
+		}
+		else
+		{
+			device->setCullMode(sw::CULL_NONE);
+		}
+
+		mCullStateDirty = false;
 	}
 
 	if(mDepthStateDirty)
@@ -3023,11 +3036,11 @@ void Context::applyState(GLenum drawMode)
 	device->setRasterizerDiscard(mState.rasterizerDiscardEnabled);
 }
 
-GLenum Context::applyVertexBuffer(GLint base, GLint first, GLsizei count, GLsizei instanceId)
+GLenum Context::applyVertexBuffer(GLint base, GLint first, GLsizei count, GLsizei instanceCount)
 {
 	TranslatedAttribute attributes[MAX_VERTEX_ATTRIBS];
 
-	GLenum err = mVertexDataManager->prepareVertexData(first, count, attributes, instanceId);
+	GLenum err = mVertexDataManager->prepareVertexData(first, count, attributes, instanceCount);
 	if(err != GL_NO_ERROR)
 	{
 		return err;
@@ -3049,10 +3062,14 @@ GLenum Context::applyVertexBuffer(GLint base, GLint first, GLsizei count, GLsize
 
 		int stride = attributes[i].stride;
 
-		buffer = (char*)buffer + stride * base;
+		if(attributes[i].divisor == 0)   // Instanced attributes are indexed by instance, not by vertex
+		{
+			buffer = (char*)buffer + stride * base;
+		}
 
 		sw::Stream attribute(resource, buffer, stride);
 
+		attribute.divisor = attributes[i].divisor;
 		attribute.type = attributes[i].type;
 		attribute.count = attributes[i].count;
 		attribute.normalized = attributes[i].normalized;
@@ -3337,7 +3354,7 @@ void Context::readPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum
 	GLsizei outputWidth = (mState.packParameters.rowLength > 0) ? mState.packParameters.rowLength : width;
 	GLsizei outputPitch = gl::ComputePitch(outputWidth, format, type, mState.packParameters.alignment);
 	GLsizei outputHeight = (mState.packParameters.imageHeight == 0) ? height : mState.packParameters.imageHeight;
-	pixels = getPixelPackBuffer() ? (unsigned char*)getPixelPackBuffer()->data() + (ptrdiff_t)pixels : (unsigned char*)pixels;
+	pixels = getPixelPackBuffer() ? (unsigned char*)getPixelPackBuffer()->modifiableData() + (ptrdiff_t)pixels : (unsigned char*)pixels;
 	pixels = ((char*)pixels) + gl::ComputePackingOffset(format, type, outputWidth, outputHeight, mState.packParameters);
 
 	// Sized query sanity check
@@ -3547,40 +3564,40 @@ void Context::drawArrays(GLenum mode, GLint first, GLsizei count, GLsizei instan
 		return error(GL_INVALID_ENUM);
 	}
 
+	if((int64_t)primitiveCount * instanceCount > INT_MAX)
+	{
+		return error(GL_OUT_OF_MEMORY);   // The renderer counts the primitives of all instances in an int
+	}
+
 	applyState(mode);
 
-	for(int i = 0; i < instanceCount; ++i)
+	GLenum err = applyVertexBuffer(0, first, count, instanceCount);
+	if(err != GL_NO_ERROR)
 	{
-		device->setInstanceID(i);
-
-		GLenum err = applyVertexBuffer(0, first, count, i);
-		if(err != GL_NO_ERROR)
-		{
-			return error(err);
-		}
+		return error(err);
+	}
 
-		applyShaders();
-		applyTextures();
+	applyShaders();
+	applyTextures();
 
-		if(!getCurrentProgram()->validateSamplers(false))
-		{
-			return error(GL_INVALID_OPERATION);
-		}
+	if(!getCurrentProgram()->validateSamplers(false))
+	{
+		return error(GL_INVALID_OPERATION);
+	}
 
-		if(primitiveCount <= 0)
-		{
-			return;
-		}
+	if(primitiveCount <= 0)
+	{
+		return;
+	}
 
-		TransformFeedback* transformFeedback = getTransformFeedback();
-		if(!cullSkipsDraw(mode) || (transformFeedback->isActive() && !transformFeedback->isPaused()))
-		{
-			device->drawPrimitive(primitiveType, primitiveCount);
-		}
-		if(transformFeedback)
-		{
-			transformFeedback->addVertexOffset(primitiveCount * verticesPerPrimitive);
-		}
+	TransformFeedback* transformFeedback = getTransformFeedback();
+	if(!cullSkipsDraw(mode) || (transformFeedback->isActive() && !transformFeedback->isPaused()))
+	{
+		device->drawPrimitive(primitiveType, primitiveCount, instanceCount);
+	}
+	if(transformFeedback)
+	{
+		transformFeedback->addVertexOffset(primitiveCount * verticesPerPrimitive * instanceCount);
 	}
 }
 
@@ -3628,6 +3645,11 @@ void Context::drawElements(GLenum mode, GLuint start, GLuint end, GLsizei count,
 		return error(GL_INVALID_ENUM);
 	}
 
+	if((int64_t)primitiveCount * instanceCount > INT_MAX)
+	{
+		return error(GL_OUT_OF_MEMORY);   // The renderer counts the primitives of all instances in an int
+	}
+
 	TranslatedIndexData indexInfo(primitiveCount);
 	GLenum err = applyIndexBuffer(indices, start, end, count, mode, type, &indexInfo);
 	if(err != GL_NO_ERROR)
@@ -3637,39 +3659,34 @@ void Context::drawElements(GLenum mode, GLuint start, GLuint end, GLsizei count,
 
 	applyState(internalMode);
 
-	for(int i = 0; i < instanceCount; ++i)
+	GLsizei vertexCount = indexInfo.maxIndex - indexInfo.minIndex + 1;
+	err = applyVertexBuffer(-(int)indexInfo.minIndex, indexInfo.minIndex, vertexCount, instanceCount);
+	if(err != GL_NO_ERROR)
 	{
-		device->setInstanceID(i);
-
-		GLsizei vertexCount = indexInfo.maxIndex - indexInfo.minIndex + 1;
-		err = applyVertexBuffer(-(int)indexInfo.minIndex, indexInfo.minIndex, vertexCount, i);
-		if(err != GL_NO_ERROR)
-		{
-			return error(err);
-		}
+		return error(err);
+	}
 
-		applyShaders();
-		applyTextures();
+	applyShaders();
+	applyTextures();
 
-		if(!getCurrentProgram()->validateSamplers(false))
-		{
-			return error(GL_INVALID_OPERATION);
-		}
+	if(!getCurrentProgram()->validateSamplers(false))
+	{
+		return error(GL_INVALID_OPERATION);
+	}
 
-		if(primitiveCount <= 0)
-		{
-			return;
-		}
+	if(primitiveCount <= 0)
+	{
+		return;
+	}
 
-		TransformFeedback* transformFeedback = getTransformFeedback();
-		if(!cullSkipsDraw(internalMode) || (transformFeedback->isActive() && !transformFeedback->isPaused()))
-		{
-			device->drawIndexedPrimitive(primitiveType, indexInfo.indexOffset, indexInfo.primitiveCount);
-		}
-		if(transformFeedback)
-		{
-			transformFeedback->addVertexOffset(indexInfo.primitiveCount * verticesPerPrimitive);
-		}
+	TransformFeedback* transformFeedback = getTransformFeedback();
+	if(!cullSkipsDraw(internalMode) || (transformFeedback->isActive() && !transformFeedback->isPaused()))
+	{
+		device->drawIndexedPrimitive(primitiveType, indexInfo.indexOffset, indexInfo.primitiveCount, instanceCount);
+	}
+	if(transformFeedback)
+	{
+		transformFeedback->addVertexOffset(indexInfo.primitiveCount * verticesPerPrimitive * instanceCount);
 	}
 }
 
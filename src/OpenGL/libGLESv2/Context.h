@@ -706,7 +706,7 @@ private:
 	void applyScissor(int width, int height);
 	bool applyRenderTarget();
 	void applyState(GLenum drawMode);
-	GLenum applyVertexBuffer(GLint base, GLint first, GLsizei count, GLsizei instanceId);
+	GLenum applyVertexBuffer(GLint base, GLint first, GLsizei count, GLsizei instanceCount);
 	GLenum applyIndexBuffer(const void *indices, GLuint start, GLuint end, GLsizei count, GLenum mode, GLenum type, TranslatedIndexData *indexInfo);
 	void applyShaders();
 	void applyTextures();
@@ -758,6 +758,7 @@ private:
 	unsigned int mAppliedProgramSerial;
 
 	// state caching flags
+	bool mCullStateDirty;
 	bool mDepthStateDirty;
 	bool mMaskStateDirty;
 	bool mBlendStateDirty;
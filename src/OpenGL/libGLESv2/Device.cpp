@@ -125,7 +125,9 @@ namespace es2
 		}
 
 		pixelShader = nullptr;
+		pixelShaderSerialID = 0;
 		vertexShader = nullptr;
+		vertexShaderSerialID = 0;
 
 		pixelShaderDirty = true;
 		pixelShaderConstantsFDirty = 0;
@@ -249,32 +251,39 @@ namespace es2
 		stencilBuffer->clearStencil(stencil, mask, clearRect.x0, clearRect.y0, clearRect.width(), clearRect.height());
 	}
 
-	void Device::drawIndexedPrimitive(sw::DrawType type, unsigned int indexOffset, unsigned int primitiveCount)
+	void Device::drawIndexedPrimitive(sw::DrawType type, unsigned int indexOffset, unsigned int primitiveCount, unsigned int instanceCount)
 	{
-		if(!bindResources() || !primitiveCount)
+		if(!bindResources() || !primitiveCount || !instanceCount)
 		{
 			return;
 		}
 
-		draw(type, indexOffset, primitiveCount);
+		draw(type, indexOffset, primitiveCount, instanceCount);
 	}
 
-	void Device::drawPrimitive(sw::DrawType type, unsigned int primitiveCount)
+	void Device::drawPrimitive(sw::DrawType type, unsigned int primitiveCount, unsigned int instanceCount)
 	{
-		if(!bindResources() || !primitiveCount)
+		if(!bindResources() || !primitiveCount || !instanceCount)
 		{
 			return;
 		}
 
 		setIndexBuffer(nullptr);
 
-		draw(type, 0, primitiveCount);
+		draw(type, 0, primitiveCount, instanceCount);
 	}
 
 	void Device::setPixelShader(const PixelShader *pixelShader)
 	{
-		this->pixelShader = pixelShader;
-		pixelShaderDirty = true;
+		// A new shader can reuse the address of a deleted one, so compare the serial ID too
+		int serialID = pixelShader ? pixelShader->getSerialID() : 0;
+
+		if(this->pixelShader != pixelShader || pixelShaderSerialID != serialID)
+		{
+			this->pixelShader = pixelShader;
+			pixelShaderSerialID = serialID;
+			pixelShaderDirty = true;
+		}
 	}
 
 	void Device::setPixelShaderConstantF(unsigned int startRegister, const float *constantData, unsigned int count)
@@ -364,8 +373,14 @@ namespace es2
 
 	void Device::setVertexShader(const VertexShader *vertexShader)
 	{
-		this->vertexShader = vertexShader;
-		vertexShaderDirty = true;
+		int serialID = vertexShader ? vertexShader->getSerialID() : 0;
+
+		if(this->vertexShader != vertexShader || vertexShaderSerialID != serialID)
+		{
+			this->vertexShader = vertexShader;
+			vertexShaderSerialID = serialID;
+			vertexShaderDirty = true;
+		}
 	}
 
 	void Device::setVertexShaderConstantF(unsigned int startRegister, const float *constantData, unsigned int count)
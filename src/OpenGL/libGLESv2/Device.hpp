@@ -58,8 +58,8 @@ namespace es2
 		void clearColor(float red, float green, float blue, float alpha, unsigned int rgbaMask);
 		void clearDepth(float z);
 		void clearStencil(unsigned int stencil, unsigned int mask);
-		void drawIndexedPrimitive(sw::DrawType type, unsigned int indexOffset, unsigned int primitiveCount);
-		void drawPrimitive(sw::DrawType type, unsigned int primiveCount);
+		void drawIndexedPrimitive(sw::DrawType type, unsigned int indexOffset, unsigned int primitiveCount, unsigned int instanceCount = 1);
+		void drawPrimitive(sw::DrawType type, unsigned int primiveCount, unsigned int instanceCount = 1);
 		void setPixelShader(const sw::PixelShader *shader);
 		void setPixelShaderConstantF(unsigned int startRegister, const float *constantData, unsigned int count);
 		void setScissorEnable(bool enable);
@@ -96,6 +96,8 @@ namespace es2
 
 		const sw::PixelShader *pixelShader;
 		const sw::VertexShader *vertexShader;
+		int pixelShaderSerialID;
+		int vertexShaderSerialID;
 
 		bool pixelShaderDirty;
 		unsigned int pixelShaderConstantsFDirty;
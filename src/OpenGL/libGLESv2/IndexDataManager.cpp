@@ -19,10 +19,15 @@
 
 #include "Buffer.h"
 #include "common/debug.h"
+#include "Common/CPUID.hpp"
 
 #include <string.h>
 #include <algorithm>
 
+#if defined(__i386__) || defined(__x86_64__)
+	#include <emmintrin.h>
+#endif
+
 namespace
 {
 	enum { INITIAL_INDEX_BUFFER_SIZE = 4096 * sizeof(GLuint) };
@@ -193,12 +198,9 @@ void copyIndices(GLenum mode, GLenum type, const std::vector<GLsizei>& restartIn
 }
 
 template<class IndexType>
-void computeRange(const IndexType *indices, GLsizei count, GLuint *minIndex, GLuint *maxIndex, std::vector<GLsizei>* restartIndices)
+void computeRange(const IndexType *indices, GLsizei begin, GLsizei end, GLuint *minIndex, GLuint *maxIndex, std::vector<GLsizei>* restartIndices)
 {
-	*maxIndex = 0;
-	*minIndex = MAX_ELEMENTS_INDICES;
-
-	for(GLsizei i = 0; i < count; i++)
+	for(GLsizei i = begin; i < end; i++)
 	{
 		if(restartIndices && indices[i] == IndexType(-1))
 		{
@@ -210,6 +212,99 @@ void computeRange(const IndexType *indices, GLsizei count, GLuint *minIndex, GLu
 	}
 }
 
+#if defined(__i386__) || defined(__x86_64__)
+// Processes 16 byte blocks of indices with SSE2, falling back to the scalar loop for
+// blocks containing primitive restart indices and for the remainder. Unsigned 16-bit
+// and 32-bit comparisons are performed as signed ones on values offset by 'bias'.
+template<class IndexType>
+void computeRangeSSE2(const IndexType *indices, GLsizei count, GLuint *minIndex, GLuint *maxIndex, std::vector<GLsizei>* restartIndices)
+{
+	const int lanes = 16 / sizeof(IndexType);
+	const __m128i bias = (sizeof(IndexType) == 1) ? _mm_setzero_si128() :
+	                     (sizeof(IndexType) == 2) ? _mm_set1_epi16((short)0x8000) : _mm_set1_epi32(0x80000000);
+	const __m128i restart = _mm_set1_epi8(-1);
+
+	__m128i minimum = _mm_set1_epi8(-1);   // Biased
+	__m128i maximum = _mm_setzero_si128();
+	minimum = _mm_xor_si128(minimum, bias);
+	maximum = _mm_xor_si128(maximum, bias);
+
+	bool vectorized = false;
+	GLsizei i = 0;
+
+	for(; i + lanes <= count; i += lanes)
+	{
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i));
+
+		if(restartIndices)
+		{
+			__m128i equal = (sizeof(IndexType) == 1) ? _mm_cmpeq_epi8(block, restart) :
+			                (sizeof(IndexType) == 2) ? _mm_cmpeq_epi16(block, restart) : _mm_cmpeq_epi32(block, restart);
+
+			if(_mm_movemask_epi8(equal) != 0)
+			{
+				computeRange(indices, i, i + lanes, minIndex, maxIndex, restartIndices);
+				continue;
+			}
+		}
+
+		vectorized = true;
+
+		if(sizeof(IndexType) == 1)
+		{
+			minimum = _mm_min_epu8(minimum, block);
+			maximum = _mm_max_epu8(maximum, block);
+		}
+		else if(sizeof(IndexType) == 2)
+		{
+			block = _mm_xor_si128(block, bias);
+			minimum = _mm_min_epi16(minimum, block);
+			maximum = _mm_max_epi16(maximum, block);
+		}
+		else
+		{
+			block = _mm_xor_si128(block, bias);
+			__m128i less = _mm_cmplt_epi32(block, minimum);
+			__m128i greater = _mm_cmpgt_epi32(block, maximum);
+			minimum = _mm_or_si128(_mm_and_si128(less, block), _mm_andnot_si128(less, minimum));
+			maximum = _mm_or_si128(_mm_and_si128(greater, block), _mm_andnot_si128(greater, maximum));
+		}
+	}
+
+	IndexType lane[2][lanes];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lane[0]), _mm_xor_si128(minimum, bias));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lane[1]), _mm_xor_si128(maximum, bias));
+
+	if(vectorized)
+	{
+		for(int j = 0; j < lanes; j++)
+		{
+			if(*minIndex > lane[0][j]) *minIndex = lane[0][j];
+			if(*maxIndex < lane[1][j]) *maxIndex = lane[1][j];
+		}
+	}
+
+	computeRange(indices, i, count, minIndex, maxIndex, restartIndices);
+}
+#endif
+
+template<class IndexType>
+void computeRange(const IndexType *indices, GLsizei count, GLuint *minIndex, GLuint *maxIndex, std::vector<GLsizei>* restartIndices)
+{
+	*maxIndex = 0;
+	*minIndex = MAX_ELEMENTS_INDICES;
+
+	#if defined(__i386__) || defined(__x86_64__)
+		if(sw::CPUID::supportsSSE2())
+		{
+			computeRangeSSE2(indices, count, minIndex, maxIndex, restartIndices);
+			return;
+		}
+	#endif
+
+	computeRange(indices, 0, count, minIndex, maxIndex, restartIndices);
+}
+
 void computeRange(GLenum type, const void *indices, GLsizei count, GLuint *minIndex, GLuint *maxIndex, std::vector<GLsizei>* restartIndices)
 {
 	if(type == GL_UNSIGNED_BYTE)
@@ -289,8 +384,25 @@ GLenum IndexDataManager::prepareIndexData(GLenum mode, GLenum type, GLuint start
 		indices = static_cast<const GLubyte*>(buffer->data()) + offset;
 	}
 
-	std::vector<GLsizei>* restartIndices = primitiveRestart ? new std::vector<GLsizei>() : nullptr;
-	computeRange(type, indices, count, &translated->minIndex, &translated->maxIndex, restartIndices);
+	// Indices stored in a buffer are usually drawn many times, so remember their range
+	const IndexRange *range = buffer ? buffer->getIndexRange(type, offset, count, primitiveRestart) : nullptr;
+	IndexRange computedRange;
+
+	if(!range)
+	{
+		computeRange(type, indices, count, &computedRange.minIndex, &computedRange.maxIndex, primitiveRestart ? &computedRange.restartIndices : nullptr);
+
+		if(buffer)
+		{
+			buffer->setIndexRange(type, offset, count, primitiveRestart, computedRange);
+		}
+
+		range = &computedRange;
+	}
+
+	translated->minIndex = range->minIndex;
+	translated->maxIndex = range->maxIndex;
+	const std::vector<GLsizei>* restartIndices = primitiveRestart ? &range->restartIndices : nullptr;
 
 	StreamingIndexBuffer *streamingBuffer = mStreamingBuffer;
 
@@ -301,7 +413,6 @@ GLenum IndexDataManager::prepareIndexData(GLenum mode, GLenum type, GLuint start
 		int vertexPerPrimitive = recomputePrimitiveCount(mode, count, *restartIndices, &translated->primitiveCount);
 		if(vertexPerPrimitive == -1)
 		{
-			delete restartIndices;
 			return GL_INVALID_ENUM;
 		}
 
@@ -313,7 +424,6 @@ GLenum IndexDataManager::prepareIndexData(GLenum mode, GLenum type, GLuint start
 
 		if(output == NULL)
 		{
-			delete restartIndices;
 			ERR("Failed to map index buffer.");
 			return GL_OUT_OF_MEMORY;
 		}
@@ -323,7 +433,6 @@ GLenum IndexDataManager::prepareIndexData(GLenum mode, GLenum type, GLuint start
 
 		translated->indexBuffer = streamingBuffer->getResource();
 		translated->indexOffset = static_cast<unsigned int>(streamOffset);
-		delete restartIndices;
 	}
 	else if(staticBuffer)
 	{
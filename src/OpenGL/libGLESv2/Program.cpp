@@ -1272,6 +1272,7 @@ namespace es2
 				int nbComponentsPerReg = rowCount > 1 ? rowCount : colCount;
 				int componentStride = rowCount * colCount * size;
 				int baseOffset = transformFeedback->vertexOffset() * componentStride * sizeof(float);
+				transformFeedbackBuffers[index].get()->setTransformFeedbackTarget();
 				device->VertexProcessor::setTransformFeedbackBuffer(index,
 					transformFeedbackBuffers[index].get()->getResource(),
 					transformFeedbackBuffers[index].getOffset() + baseOffset,
@@ -1287,6 +1288,7 @@ namespace es2
 			// In INTERLEAVED_ATTRIBS mode, the values of one or more output variables
 			// written by a vertex shader are written, interleaved, into the buffer object
 			// bound to the first transform feedback binding point (index = 0).
+			transformFeedbackBuffers[0].get()->setTransformFeedbackTarget();
 			sw::Resource* resource = transformFeedbackBuffers[0].get()->getResource();
 			int componentStride = static_cast<int>(totalLinkedVaryingsComponents);
 			int baseOffset = transformFeedbackBuffers[0].getOffset() + (transformFeedback->vertexOffset() * componentStride * sizeof(float));
@@ -2564,6 +2566,23 @@ namespace es2
 		return applyUniform(device, location, (float*)vector);
 	}
 
+	void Program::applyDepthRange(float zNear, float zFar)
+	{
+		if(depthRangeApplied && appliedDepthRange[0] == zNear && appliedDepthRange[1] == zFar)
+		{
+			return;
+		}
+
+		GLfloat nearFarDiff[3] = {zNear, zFar, zFar - zNear};
+		setUniform1fv(getUniformLocation("gl_DepthRange.near"), 1, &nearFarDiff[0]);
+		setUniform1fv(getUniformLocation("gl_DepthRange.far"), 1, &nearFarDiff[1]);
+		setUniform1fv(getUniformLocation("gl_DepthRange.diff"), 1, &nearFarDiff[2]);
+
+		appliedDepthRange[0] = zNear;
+		appliedDepthRange[1] = zFar;
+		depthRangeApplied = true;
+	}
+
 	void Program::appendToInfoLog(const char *format, ...)
 	{
 		if(!format)
@@ -2652,6 +2671,7 @@ namespace es2
 		delete[] infoLog;
 		infoLog = 0;
 
+		depthRangeApplied = false;
 		linked = false;
 	}
 
@@ -175,6 +175,7 @@ namespace es2
 
 		void dirtyAllUniforms();
 		void applyUniforms(Device *device);
+		void applyDepthRange(float zNear, float zFar);   // Sets the gl_DepthRange uniforms if they hold other values
 		void applyUniformBuffers(Device *device, BufferBinding* uniformBuffers);
 		void applyTransformFeedback(Device *device, TransformFeedback* transformFeedback);
 
@@ -314,6 +315,9 @@ namespace es2
 		typedef std::vector<LinkedVarying> LinkedVaryingArray;
 		LinkedVaryingArray transformFeedbackLinkedVaryings;
 
+		bool depthRangeApplied;   // The gl_DepthRange uniforms hold appliedDepthRange, shared by all contexts using the program
+		float appliedDepthRange[2];
+
 		bool linked;
 		bool orphaned;   // Flag to indicate that the program can be deleted when no longer in use
 		char *infoLog;
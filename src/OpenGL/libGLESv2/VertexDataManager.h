@@ -33,7 +33,8 @@ struct TranslatedAttribute
 	bool normalized;
 
 	unsigned int offset;
-	unsigned int stride;   // 0 means not to advance the read pointer at all
+	unsigned int stride;    // 0 means not to advance the read pointer at all
+	unsigned int divisor;   // Advance per 'divisor' instances instead of per vertex, when non-zero
 
 	sw::Resource *vertexBuffer;
 };
@@ -83,7 +84,7 @@ public:
 
 	void dirtyCurrentValue(int index) { mDirtyCurrentValue[index] = true; }
 
-	GLenum prepareVertexData(GLint start, GLsizei count, TranslatedAttribute *outAttribs, GLsizei instanceId);
+	GLenum prepareVertexData(GLint start, GLsizei count, TranslatedAttribute *outAttribs, GLsizei instanceCount);
 
 private:
 	unsigned int writeAttributeData(StreamingVertexBuffer *vertexBuffer, GLint start, GLsizei count, const VertexAttribute &attribute);
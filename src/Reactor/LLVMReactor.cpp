@@ -77,6 +77,9 @@ namespace
 namespace sw
 {
 	Optimization optimization[10] = {InstructionCombining, Disabled};
+	thread_local bool optimizeRoutines = true;
+	const bool minimalOptimizationSupported = true;
+	const bool objectCodeSupported = false;   // JIT-compiled code contains absolute addresses
 
 	enum EmulatedType
 	{
@@ -266,7 +269,7 @@ namespace sw
 			::module->print(file, 0);
 		}
 
-		if(runOptimizations)
+		if(runOptimizations && optimizeRoutines)
 		{
 			optimize();
 		}
@@ -289,6 +292,11 @@ namespace sw
 		return routine;
 	}
 
+	Routine *Nucleus::loadRoutine(const void *object, size_t size)
+	{
+		return nullptr;   // JIT-compiled code is not relocatable
+	}
+
 	void Nucleus::optimize()
 	{
 		static llvm::PassManager *passManager = nullptr;
@@ -16,6 +16,9 @@
 
 #include "gtest/gtest.h"
 
+#include <thread>
+#include <vector>
+
 using namespace sw;
 
 int reference(int *p, int y)
@@ -992,6 +995,63 @@ TEST(SubzeroReactorTest, MulAdd)
 	delete routine;
 }
 
+TEST(SubzeroReactorTest, ConcurrentCompilation)
+{
+	const int threadCount = 8;
+	const int routinesPerThread = 32;
+
+	int failures[threadCount] = {};
+	std::vector<std::thread> threads;
+
+	for(int t = 0; t < threadCount; t++)
+	{
+		threads.push_back(std::thread([t, &failures]()
+		{
+			for(int i = 0; i < routinesPerThread; i++)
+			{
+				int id = t * routinesPerThread + i;
+				Routine *routine = nullptr;
+
+				{
+					Function<Int(Int)> function;
+					{
+						Int x = function.Arg<0>();
+						Int y = id;
+
+						For(Int j = 0, j < 4, j++)
+						{
+							y += x * (j + id);
+						}
+
+						Return(y);
+					}
+
+					routine = function(L"concurrent");
+				}
+
+				int (*callable)(int) = (int(*)(int))routine->getEntry();
+
+				if(callable(3) != id + 3 * (4 * id + 6))
+				{
+					failures[t]++;
+				}
+
+				delete routine;
+			}
+		}));
+	}
+
+	for(auto &thread : threads)
+	{
+		thread.join();
+	}
+
+	for(int t = 0; t < threadCount; t++)
+	{
+		EXPECT_EQ(failures[t], 0);
+	}
+}
+
 int main(int argc, char **argv)
 {
 	::testing::InitGoogleTest(&argc, argv);
@@ -17,6 +17,7 @@
 
 #include <cassert>
 #include <cstdarg>
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -46,6 +47,13 @@ namespace sw
 
 	extern Optimization optimization[10];
 
+	// Routines acquired by the current thread while this is false are compiled with minimal
+	// optimization, trading code quality for compile time. Only has an effect when the
+	// backend supports it.
+	extern thread_local bool optimizeRoutines;
+	extern const bool minimalOptimizationSupported;
+	extern const bool objectCodeSupported;   // Routine::getObject() and Nucleus::loadRoutine() are implemented
+
 	class Nucleus
 	{
 	public:
@@ -55,6 +63,10 @@ namespace sw
 
 		Routine *acquireRoutine(const wchar_t *name, bool runOptimizations = true);
 
+		// Recreates a routine from the object code of Routine::getObject(). Returns null if
+		// the object is invalid or the backend doesn't support it.
+		static Routine *loadRoutine(const void *object, size_t size);
+
 		static Value *allocateStackVariable(Type *type, int arraySize = 0);
 		static BasicBlock *createBasicBlock();
 		static BasicBlock *getInsertBlock();
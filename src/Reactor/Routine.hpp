@@ -15,6 +15,8 @@
 #ifndef sw_Routine_hpp
 #define sw_Routine_hpp
 
+#include <cstddef>
+
 namespace sw
 {
 	class Routine
@@ -26,6 +28,10 @@ namespace sw
 
 		virtual const void *getEntry() = 0;
 
+		// Relocatable object code which Nucleus::loadRoutine() accepts, for persistent caching.
+		// Not all backends provide it, and it's no longer available once getEntry() was called.
+		virtual const void *getObject(size_t &size) { size = 0; return nullptr; }
+
 		// Reference counting
 		void bind();
 		void unbind();
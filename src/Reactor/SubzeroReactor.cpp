@@ -42,23 +42,25 @@
 #endif
 #endif
 
-//#include <mutex>
+#include <mutex>
 #include <limits>
 #include <iostream>
 #include <cassert>
 
 namespace
 {
-	Ice::GlobalContext *context = nullptr;
-	Ice::Cfg *function = nullptr;
-	Ice::CfgNode *basicBlock = nullptr;
-	Ice::CfgLocalAllocatorScope *allocator = nullptr;
-	sw::Routine *routine = nullptr;
-
-	std::mutex codegenMutex;
-
-	Ice::ELFFileStreamer *elfFile = nullptr;
-	Ice::Fdstream *out = nullptr;
+	// Each thread builds its own routine, so independent routines compile concurrently
+	thread_local Ice::GlobalContext *context = nullptr;
+	thread_local Ice::Cfg *function = nullptr;
+	thread_local Ice::CfgNode *basicBlock = nullptr;
+	thread_local Ice::CfgLocalAllocatorScope *allocator = nullptr;
+	thread_local sw::Routine *routine = nullptr;
+
+	thread_local Ice::ELFFileStreamer *elfFile = nullptr;
+	thread_local Ice::Fdstream *out = nullptr;
+
+	std::once_flag flagsInitialized;
+	std::mutex contextMutex;   // Subzero initializes static target tables in the GlobalContext constructor
 }
 
 namespace
@@ -191,6 +193,9 @@ namespace sw
 	}
 
 	Optimization optimization[10] = {InstructionCombining, Disabled};
+	thread_local bool optimizeRoutines = true;
+	const bool minimalOptimizationSupported = false;   // Routines aren't tiered, Om1 lowering emits relocations against unnamed constants which can't be resolved
+	const bool objectCodeSupported = true;
 
 	using ElfHeader = std::conditional<sizeof(void*) == 8, Elf64_Ehdr, Elf32_Ehdr>::type;
 	using SectionHeader = std::conditional<sizeof(void*) == 8, Elf64_Shdr, Elf32_Shdr>::type;
@@ -348,6 +353,45 @@ namespace sw
 		return symbolValue;
 	}
 
+	// Checks that the headers of an ELF image produced by Subzero are consistent with its size
+	bool validateImage(const uint8_t *elfImage, size_t size)
+	{
+		const ElfHeader *elfHeader = (const ElfHeader*)elfImage;
+
+		if(size < sizeof(ElfHeader) || !elfHeader->checkMagic())
+		{
+			return false;
+		}
+
+		if(elfHeader->e_shoff > size || elfHeader->e_shnum > (size - elfHeader->e_shoff) / sizeof(SectionHeader))
+		{
+			return false;
+		}
+
+		const SectionHeader *sectionHeader = (const SectionHeader*)(elfImage + elfHeader->e_shoff);
+
+		for(int i = 0; i < elfHeader->e_shnum; i++)
+		{
+			if(sectionHeader[i].sh_type != SHT_NOBITS &&
+			   (sectionHeader[i].sh_offset > size || sectionHeader[i].sh_size > size - sectionHeader[i].sh_offset))
+			{
+				return false;
+			}
+
+			if(sectionHeader[i].sh_type == SHT_REL || sectionHeader[i].sh_type == SHT_RELA)
+			{
+				if(sectionHeader[i].sh_entsize == 0 ||
+				   sectionHeader[i].sh_info >= elfHeader->e_shnum ||
+				   sectionHeader[i].sh_link >= elfHeader->e_shnum)
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
 	void *loadImage(uint8_t *const elfImage, size_t &codeSize)
 	{
 		ElfHeader *elfHeader = (ElfHeader*)elfImage;
@@ -485,6 +529,13 @@ namespace sw
 
 		void seek(uint64_t Off) override { position = Off; }
 
+		const void *getObject(size_t &size) override
+		{
+			size = entry ? 0 : buffer.size();   // Relocations are applied in place by getEntry()
+
+			return size ? &buffer[0] : nullptr;
+		}
+
 		const void *getEntry() override
 		{
 			if(!entry)
@@ -518,27 +569,33 @@ namespace sw
 
 	Nucleus::Nucleus()
 	{
-		::codegenMutex.lock();   // Reactor is currently not thread safe
+		assert(!::context && "Only one Nucleus can be active per thread");
 
-		Ice::ClFlags &Flags = Ice::ClFlags::Flags;
-		Ice::ClFlags::getParsedClFlags(Flags);
+		// The flags are global, so they must not change while other threads are compiling
+		std::call_once(flagsInitialized, []()
+		{
+			Ice::ClFlags &Flags = Ice::ClFlags::Flags;
+			Ice::ClFlags::getParsedClFlags(Flags);
 
-		#if defined(__arm__)
-			Flags.setTargetArch(Ice::Target_ARM32);
-			Flags.setTargetInstructionSet(Ice::ARM32InstructionSet_HWDivArm);
-		#else   // x86
-			Flags.setTargetArch(sizeof(void*) == 8 ? Ice::Target_X8664 : Ice::Target_X8632);
-			Flags.setTargetInstructionSet(CPUID::SSE4_1 ? Ice::X86InstructionSet_SSE4_1 : Ice::X86InstructionSet_SSE2);
-		#endif
-		Flags.setOutFileType(Ice::FT_Elf);
-		Flags.setOptLevel(Ice::Opt_2);
-		Flags.setApplicationBinaryInterface(Ice::ABI_Platform);
-		Flags.setVerbose(false ? Ice::IceV_Most : Ice::IceV_None);
-		Flags.setDisableHybridAssembly(true);
+			#if defined(__arm__)
+				Flags.setTargetArch(Ice::Target_ARM32);
+				Flags.setTargetInstructionSet(Ice::ARM32InstructionSet_HWDivArm);
+			#else   // x86
+				Flags.setTargetArch(sizeof(void*) == 8 ? Ice::Target_X8664 : Ice::Target_X8632);
+				Flags.setTargetInstructionSet(CPUID::SSE4_1 ? Ice::X86InstructionSet_SSE4_1 : Ice::X86InstructionSet_SSE2);
+			#endif
+			Flags.setOutFileType(Ice::FT_Elf);
+			Flags.setOptLevel(Ice::Opt_2);
+			Flags.setApplicationBinaryInterface(Ice::ABI_Platform);
+			Flags.setVerbose(false ? Ice::IceV_Most : Ice::IceV_None);
+			Flags.setDisableHybridAssembly(true);
+		});
 
 		static llvm::raw_os_ostream cout(std::cout);
 		static llvm::raw_os_ostream cerr(std::cerr);
 
+		std::lock_guard<std::mutex> lock(contextMutex);
+
 		if(false)   // Write out to a file
 		{
 			std::error_code errorCode;
@@ -565,7 +622,13 @@ namespace sw
 		delete ::elfFile;
 		delete ::out;
 
-		::codegenMutex.unlock();
+		::routine = nullptr;
+		::allocator = nullptr;
+		::function = nullptr;
+		::context = nullptr;
+		::elfFile = nullptr;
+		::out = nullptr;
+		::basicBlock = nullptr;
 	}
 
 	Routine *Nucleus::acquireRoutine(const wchar_t *name, bool runOptimizations)
@@ -609,6 +672,25 @@ namespace sw
 		return handoffRoutine;
 	}
 
+	Routine *Nucleus::loadRoutine(const void *object, size_t size)
+	{
+		if(!validateImage((const uint8_t*)object, size))
+		{
+			return nullptr;
+		}
+
+		ELFMemoryStreamer *routine = new ELFMemoryStreamer();
+		routine->writeBytes(llvm::StringRef((const char*)object, size));
+
+		if(!routine->getEntry())
+		{
+			delete routine;
+			return nullptr;
+		}
+
+		return routine;
+	}
+
 	void Nucleus::optimize()
 	{
 		sw::optimize(::function);
@@ -99,6 +99,12 @@ namespace sw
 			return false;
 		}
 
+		if(dest->isEntire(dRect) && dest->getInternalFormat() == dest->getFormat() && dest->supportsDeferredClear())
+		{
+			dest->deferClear(packed);
+			return true;
+		}
+
 		bool useDestInternal = !dest->isExternalDirty();
 		uint8_t *slice = (uint8_t*)dest->lock(dRect.x0, dRect.y0, dRect.slice, sw::LOCK_WRITEONLY, sw::PUBLIC, useDestInternal);
 
@@ -1420,6 +1426,7 @@ namespace sw
 		state.sourceFormat = isStencil ? source->getStencilFormat() : source->getFormat(useSourceInternal);
 		state.destFormat = isStencil ? dest->getStencilFormat() : dest->getFormat(useDestInternal);
 		state.destSamples = dest->getSamples();
+		state.hash = state.computeHash();
 
 		criticalSection.lock();
 		Routine *blitRoutine = blitCache->query(state);
@@ -56,7 +56,16 @@ namespace sw
 		struct State : Options
 		{
 			State() = default;
-			State(const Options &options) : Options(options) {}
+			State(const Options &options)
+			{
+				memset(this, 0, sizeof(State));   // Padding is hashed and compared too
+				*static_cast<Options*>(this) = options;
+			}
+
+			uint64_t computeHash() const
+			{
+				return FNV_1a(reinterpret_cast<const unsigned char*>(this), OFFSET(State,hash));
+			}
 
 			bool operator==(const State &state) const
 			{
@@ -66,6 +75,8 @@ namespace sw
 			Format sourceFormat;
 			Format destFormat;
 			int destSamples;
+
+			uint64_t hash;
 		};
 
 		struct BlitData
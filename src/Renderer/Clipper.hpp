@@ -20,9 +20,7 @@
 
 namespace sw
 {
-	struct Polygon;
 	struct DrawCall;
-	struct DrawData;
 
 	class Clipper
 	{
@@ -38,8 +36,10 @@ namespace sw
 			CLIP_NEAR   = 1 << 5,
 
 			CLIP_FRUSTUM = 0x003F,
+			CLIP_SIDES = CLIP_LEFT | CLIP_RIGHT | CLIP_TOP | CLIP_BOTTOM,
 
-			CLIP_FINITE = 1 << 7,   // All position coordinates are finite
+			CLIP_GUARDBAND = 1 << 6,   // Outside the guard band, so the sides can't be left to scissoring
+			CLIP_FINITE = 1 << 7,      // All position coordinates are finite
 
 			// User-defined clipping planes
 			CLIP_PLANE0 = 1 << 8,
@@ -57,19 +57,9 @@ namespace sw
 		~Clipper();
 
 		unsigned int computeClipFlags(const float4 &v);
-		bool clip(Polygon &polygon, int clipFlagsOr, const DrawCall &draw);
+		static int clipFlagsOr(int clipFlags, const DrawCall &draw);
 
 	private:
-		void clipNear(Polygon &polygon);
-		void clipFar(Polygon &polygon);
-		void clipLeft(Polygon &polygon);
-		void clipRight(Polygon &polygon);
-		void clipTop(Polygon &polygon);
-		void clipBottom(Polygon &polygon);
-		void clipPlane(Polygon &polygon, const Plane &plane);
-
-		void clipEdge(float4 &Vo, const float4 &Vi, const float4 &Vj, float di, float dj) const;
-
 		float n;   // Near clip plane distance
 	};
 }
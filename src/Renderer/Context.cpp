@@ -43,6 +43,7 @@ namespace sw
 	bool exactColorRounding = false;
 	TransparencyAntialiasing transparencyAntialiasing = TRANSPARENCY_NONE;
 	bool forceClearRegisters = false;
+	bool tileRasterization = false;          // Threads render whole screen tiles instead of interleaved scanlines
 
 	Context::Context()
 	{
@@ -302,8 +303,6 @@ namespace sw
 		pixelShader = 0;
 		vertexShader = 0;
 
-		instanceID = 0;
-
 		occlusionEnabled = false;
 		transformFeedbackQueryEnabled = false;
 		transformFeedbackEnabled = 0;
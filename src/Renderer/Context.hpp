@@ -489,9 +489,6 @@ namespace sw
 		// Global mipmap bias
 		float bias;
 
-		// Instancing
-		int instanceID;
-
 		// Fixed-function vertex pipeline state
 		bool lightingEnable;
 		bool specularEnable;
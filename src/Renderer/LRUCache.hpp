@@ -19,6 +19,9 @@
 
 namespace sw
 {
+	// Least recently used cache, indexed by a hash table. Keys must provide a 64-bit
+	// 'hash' member which is computed before they're used for lookups, so that
+	// queries only compare full keys when their hashes are equal.
 	template<class Key, class Data>
 	class LRUCache
 	{
@@ -27,21 +30,45 @@ namespace sw
 
 		~LRUCache();
 
-		Data *query(const Key &key) const;
+		Data *query(const Key &key);
 		Data *add(const Key &key, Data *data);
-	
+
 		int getSize() {return size;}
-		Key &getKey(int i) {return key[i];}
+		int getFill() {return fill;}
+
+		uint64_t getHits() const {return hits;}
+		uint64_t getMisses() const {return misses;}
+		uint64_t getEvictions() const {return evictions;}
 
 	private:
+		enum {NONE = -1};
+
+		struct Entry
+		{
+			Key key;
+			Data *data;
+
+			int newer;   // Neighbours in the recency list
+			int older;
+			int chain;   // Next entry in the same hash bucket
+		};
+
+		void unlink(int index);
+		void makeNewest(int index);
+		int &bucket(uint64_t hash);
+
 		int size;
-		int mask;
-		int top;
 		int fill;
+		int newest;
+		int oldest;
 
-		Key *key;
-		Key **ref;
-		Data **data;
+		Entry *entry;
+		int *buckets;   // Twice the number of entries to keep the chains short
+		int bucketMask;
+
+		uint64_t hits;
+		uint64_t misses;
+		uint64_t evictions;
 	};
 }
 
@@ -51,94 +78,141 @@ namespace sw
 	LRUCache<Key, Data>::LRUCache(int n)
 	{
 		size = ceilPow2(n);
-		mask = size - 1;
-		top = 0;
 		fill = 0;
+		newest = NONE;
+		oldest = NONE;
 
-		key = new Key[size];
-		ref = new Key*[size];
-		data = new Data*[size];
+		entry = new Entry[size];
+		buckets = new int[2 * size];
+		bucketMask = 2 * size - 1;
 
 		for(int i = 0; i < size; i++)
 		{
-			data[i] = nullptr;
+			entry[i].data = nullptr;
+		}
 
-			ref[i] = &key[i];
+		for(int i = 0; i < 2 * size; i++)
+		{
+			buckets[i] = NONE;
 		}
+
+		hits = 0;
+		misses = 0;
+		evictions = 0;
 	}
 
 	template<class Key, class Data>
 	LRUCache<Key, Data>::~LRUCache()
 	{
-		delete[] key;
-		key = nullptr;
+		for(int i = 0; i < fill; i++)
+		{
+			entry[i].data->unbind();
+			entry[i].data = nullptr;
+		}
 
-		delete[] ref;
-		ref = nullptr;
+		delete[] entry;
+		entry = nullptr;
 
-		for(int i = 0; i < size; i++)
+		delete[] buckets;
+		buckets = nullptr;
+	}
+
+	template<class Key, class Data>
+	Data *LRUCache<Key, Data>::query(const Key &key)
+	{
+		for(int i = bucket(key.hash); i != NONE; i = entry[i].chain)
 		{
-			if(data[i])
+			if(entry[i].key.hash == key.hash && entry[i].key == key)
 			{
-				data[i]->unbind();
-				data[i] = nullptr;
+				if(i != newest)
+				{
+					unlink(i);
+					makeNewest(i);
+				}
+
+				hits++;
+
+				return entry[i].data;
 			}
 		}
 
-		delete[] data;
-		data = nullptr;
+		misses++;
+
+		return nullptr;   // Not found
 	}
 
 	template<class Key, class Data>
-	Data *LRUCache<Key, Data>::query(const Key &key) const
+	Data *LRUCache<Key, Data>::add(const Key &key, Data *data)
 	{
-		for(int i = top; i > top - fill; i--)
+		int index;
+
+		data->bind();
+
+		if(fill < size)
+		{
+			index = fill++;
+		}
+		else   // Evict the least recently used entry
 		{
-			int j = i & mask;
+			index = oldest;
+			unlink(index);
 
-			if(key == *ref[j])
+			for(int *link = &bucket(entry[index].key.hash); ; link = &entry[*link].chain)
 			{
-				Data *hit = data[j];
-
-				if(i != top)
+				if(*link == index)
 				{
-					// Move one up
-					int k = (j + 1) & mask;
-
-					Data *swapD = data[k];
-					data[k] = data[j];
-					data[j] = swapD;
-
-					Key *swapK = ref[k];
-					ref[k] = ref[j];
-					ref[j] = swapK;
+					*link = entry[index].chain;
+					break;
 				}
-
-				return hit;
 			}
+
+			entry[index].data->unbind();
+			evictions++;
 		}
 
-		return nullptr;   // Not found
+		int &head = bucket(key.hash);
+
+		entry[index].key = key;
+		entry[index].data = data;
+		entry[index].chain = head;
+		head = index;
+
+		makeNewest(index);
+
+		return data;
 	}
 
 	template<class Key, class Data>
-	Data *LRUCache<Key, Data>::add(const Key &key, Data *data)
+	void LRUCache<Key, Data>::unlink(int index)
 	{
-		top = (top + 1) & mask;
-		fill = fill + 1 < size ? fill + 1 : size;
+		Entry &e = entry[index];
 
-		*ref[top] = key;
+		if(e.newer != NONE) entry[e.newer].older = e.older; else newest = e.older;
+		if(e.older != NONE) entry[e.older].newer = e.newer; else oldest = e.newer;
+	}
 
-		data->bind();
+	template<class Key, class Data>
+	void LRUCache<Key, Data>::makeNewest(int index)
+	{
+		entry[index].newer = NONE;
+		entry[index].older = newest;
 
-		if(this->data[top])
+		if(newest != NONE)
 		{
-			this->data[top]->unbind();
+			entry[newest].newer = index;
+		}
+		else
+		{
+			oldest = index;
 		}
 
-		this->data[top] = data;
+		newest = index;
+	}
 
-		return data;
+	template<class Key, class Data>
+	int &LRUCache<Key, Data>::bucket(uint64_t hash)
+	{
+		return buckets[(hash ^ (hash >> 32)) & bucketMask];
 	}
 }
 
@@ -0,0 +1,68 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "OutlineBuffer.hpp"
+
+#include "Common/Memory.hpp"
+#include "Common/Debug.hpp"
+
+namespace sw
+{
+	static const int CHUNK_SIZE = 16384;   // Spans
+
+	OutlineBuffer::OutlineBuffer() : current(0), used(0)
+	{
+	}
+
+	OutlineBuffer::~OutlineBuffer()
+	{
+		for(auto &chunk : chunks)
+		{
+			deallocate(chunk.spans);
+		}
+	}
+
+	void OutlineBuffer::reset()
+	{
+		current = 0;
+		used = 0;
+	}
+
+	Primitive::Span *OutlineBuffer::reserve(int spans)
+	{
+		while(current < chunks.size() && chunks[current].size - used < spans)
+		{
+			current++;
+			used = 0;
+		}
+
+		if(current == chunks.size())
+		{
+			Chunk chunk;
+			chunk.size = spans > CHUNK_SIZE ? spans : CHUNK_SIZE;
+			chunk.spans = (Primitive::Span*)allocate(chunk.size * sizeof(Primitive::Span));
+
+			chunks.push_back(chunk);
+		}
+
+		return chunks[current].spans + used;
+	}
+
+	void OutlineBuffer::commit(int spans)
+	{
+		used += (spans + 1) & ~1;   // Keep pairs of spans 8-byte aligned
+
+		ASSERT(used <= chunks[current].size);
+	}
+}
@@ -0,0 +1,53 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef sw_OutlineBuffer_hpp
+#define sw_OutlineBuffer_hpp
+
+#include "Primitive.hpp"
+
+#include <vector>
+
+namespace sw
+{
+	// Storage for the outlines of a batch of primitives. Each primitive only
+	// uses the spans it covers, which are packed into chunks that are kept
+	// around for the next batch.
+	class OutlineBuffer
+	{
+	public:
+		OutlineBuffer();
+
+		~OutlineBuffer();
+
+		void reset();
+
+		// Returns storage for up to 'spans' spans. Remains valid until reset().
+		Primitive::Span *reserve(int spans);
+		void commit(int spans);
+
+	private:
+		struct Chunk
+		{
+			Primitive::Span *spans;
+			int size;
+		};
+
+		std::vector<Chunk> chunks;
+		size_t current;   // Chunk being filled
+		int used;         // Spans used in the current chunk
+	};
+}
+
+#endif   // sw_OutlineBuffer_hpp
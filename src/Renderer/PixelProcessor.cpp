@@ -14,6 +14,7 @@
 
 #include "PixelProcessor.hpp"
 
+#include "RoutineCompiler.hpp"
 #include "Surface.hpp"
 #include "Primitive.hpp"
 #include "Shader/PixelPipeline.hpp"
@@ -22,6 +23,7 @@
 #include "Shader/Constants.hpp"
 #include "Common/Debug.hpp"
 
+#include <memory>
 #include <string.h>
 
 namespace sw
@@ -29,20 +31,13 @@ namespace sw
 	extern bool complementaryDepthBuffer;
 	extern TransparencyAntialiasing transparencyAntialiasing;
 	extern bool perspectiveCorrection;
+	extern bool tileRasterization;
 
 	bool precachePixel = false;
 
-	unsigned int PixelProcessor::States::computeHash()
+	uint64_t PixelProcessor::States::computeHash()
 	{
-		unsigned int *state = (unsigned int*)this;
-		unsigned int hash = 0;
-
-		for(unsigned int i = 0; i < sizeof(States) / 4; i++)
-		{
-			hash ^= state[i];
-		}
-
-		return hash;
+		return FNV_1a(reinterpret_cast<const unsigned char*>(this), sizeof(States));
 	}
 
 	PixelProcessor::State::State()
@@ -949,7 +944,7 @@ namespace sw
 
 		if(context->pixelShader)
 		{
-			state.shaderID = context->pixelShader->getSerialID();
+			state.shaderID = context->pixelShader->getHash();
 		}
 		else
 		{
@@ -1032,6 +1027,31 @@ namespace sw
 			state.centroid = context->pixelShader->containsCentroid();
 		}
 
+		state.tileRasterization = tileRasterization;
+
+		if(state.depthTestActive && context->depthBuffer->hasHiZ())
+		{
+			bool lessCompare = (state.depthCompareMode == DEPTH_LESS || state.depthCompareMode == DEPTH_LESSEQUAL) && !complementaryDepthBuffer;
+
+			// Tiles are only rasterized by one thread in tile mode, so they can be tested and updated without races
+			state.hiZTest = tileRasterization && lessCompare && state.multiSample == 1 && !state.depthOverride && !state.stencilActive;
+			state.hiZUpdate = state.hiZTest && state.depthWriteEnable && !state.alphaTestActive() && !state.shaderContainsKill;
+			state.hiZInvalidate = state.depthWriteEnable && !lessCompare && state.depthCompareMode != DEPTH_NEVER;
+		}
+
+		if(tileRasterization)
+		{
+			for(int i = 0; i < RENDERTARGETS; i++)
+			{
+				if(state.colorWriteActive(i) && context->renderTarget[i]->supportsDeferredClear())
+				{
+					state.deferredClearTargets |= 1 << i;
+				}
+			}
+
+			state.deferredClearDepth = state.depthTestActive && context->depthBuffer->supportsDeferredClear();
+		}
+
 		if(!context->pixelShader)
 		{
 			for(unsigned int i = 0; i < 8; i++)
@@ -1165,35 +1185,61 @@ namespace sw
 			}
 		}
 
-		state.hash = state.computeHash();
-
 		return state;
 	}
 
-	Routine *PixelProcessor::routine(const State &state)
+	Routine *PixelProcessor::routine(const State &state, RoutineCompiler *compiler)
 	{
 		Routine *routine = routineCache->query(state);
 
 		if(!routine)
 		{
 			const bool integerPipeline = (context->pixelShaderModel() <= 0x0104);
-			QuadRasterizer *generator = nullptr;
 
-			if(integerPipeline)
-			{
-				generator = new PixelPipeline(state, context->pixelShader);
-			}
-			else
-			{
-				generator = new PixelProgram(state, context->pixelShader);
-			}
-
-			generator->generate();
-			routine = (*generator)(L"PixelRoutine_%0.8X", state.shaderID);
-			delete generator;
+			// Background and tiered compilation generate the routine later, after the application may have deleted the shader
+			std::shared_ptr<const PixelShader> shader(context->pixelShader ? new PixelShader(*context->pixelShader) : nullptr);
 
+			routine = compileRoutine(compiler, [state, shader, integerPipeline]() { return generate(state, shader.get(), integerPipeline); }, precachePixel);
 			routineCache->add(state, routine);
+			routine->unbind();
+		}
+
+		return routine;
+	}
+
+	Routine *PixelProcessor::fallbackRoutine(const State &state, RoutineCompiler *compiler)
+	{
+		State fallback = state;
+
+		fallback.alphaBlendActive = false;
+		fallback.sourceBlendFactor = (BlendFactor)0;
+		fallback.destBlendFactor = (BlendFactor)0;
+		fallback.blendOperation = (BlendOperation)0;
+		fallback.sourceBlendFactorAlpha = (BlendFactor)0;
+		fallback.destBlendFactorAlpha = (BlendFactor)0;
+		fallback.blendOperationAlpha = (BlendOperation)0;
+		fallback.dynamicBlend = true;
+		fallback.hash = fallback.computeHash();
+
+		return routine(fallback, compiler);
+	}
+
+	Routine *PixelProcessor::generate(const State &state, const PixelShader *shader, bool integerPipeline)
+	{
+		QuadRasterizer *generator = nullptr;
+
+		if(integerPipeline)
+		{
+			generator = new PixelPipeline(state, shader);
 		}
+		else
+		{
+			generator = new PixelProgram(state, shader);
+		}
+
+		generator->generate();
+		Routine *routine = (*generator)(L"PixelRoutine_%0.8X", (unsigned int)state.shaderID);
+		delete generator;
 
 		return routine;
 	}
@@ -22,6 +22,7 @@ namespace sw
 {
 	class PixelShader;
 	class Rasterizer;
+	class RoutineCompiler;
 	struct Texture;
 	struct DrawData;
 
@@ -30,9 +31,9 @@ namespace sw
 	public:
 		struct States
 		{
-			unsigned int computeHash();
+			uint64_t computeHash();
 
-			int shaderID;
+			uint64_t shaderID;
 
 			bool depthOverride                        : 1;   // TODO: Eliminate by querying shader.
 			bool shaderContainsKill                   : 1;   // TODO: Eliminate by querying shader.
@@ -75,6 +76,7 @@ namespace sw
 			BlendFactor sourceBlendFactorAlpha        : BITS(BLEND_LAST);
 			BlendFactor destBlendFactorAlpha          : BITS(BLEND_LAST);
 			BlendOperation blendOperationAlpha        : BITS(BLENDOP_LAST);
+			bool dynamicBlend                         : 1;   // Blend state is read from DrawData, the fields above are zero
 
 			unsigned int colorWriteMask                       : RENDERTARGETS * 4;   // Four component bit masks
 			Format targetFormat[RENDERTARGETS];
@@ -83,6 +85,12 @@ namespace sw
 			unsigned int multiSampleMask                      : 4;
 			TransparencyAntialiasing transparencyAntialiasing : BITS(TRANSPARENCY_LAST);
 			bool centroid                                     : 1;
+			bool tileRasterization                            : 1;
+			bool hiZTest                                      : 1;   // Skip tiles where the depth test fails everywhere
+			bool hiZUpdate                                    : 1;   // Lower the maximum depth of fully covered tiles
+			bool hiZInvalidate                                : 1;   // Depth writes which can increase depth
+			unsigned int deferredClearTargets                 : RENDERTARGETS;   // Fill cleared tiles on first access
+			bool deferredClearDepth                           : 1;
 
 			LogicalOperation logicalOperation : BITS(LOGICALOP_LAST);
 
@@ -131,7 +139,7 @@ namespace sw
 				return pixelFogMode != FOG_NONE;
 			}
 
-			unsigned int hash;
+			uint64_t hash;
 		};
 
 		struct Stencil
@@ -171,6 +179,17 @@ namespace sw
 			float4 density2E;
 		};
 
+		struct Blend   // Read by routines compiled with dynamic blending
+		{
+			int alphaBlendActive;
+			int sourceBlendFactor;
+			int destBlendFactor;
+			int blendOperation;
+			int sourceBlendFactorAlpha;
+			int destBlendFactorAlpha;
+			int blendOperationAlpha;
+		};
+
 		struct Factor
 		{
 			word4 textureFactor4[4];
@@ -303,8 +322,9 @@ namespace sw
 		void setOcclusionEnabled(bool enable);
 
 	protected:
-		const State update() const;
-		Routine *routine(const State &state);
+		const State update() const;   // Leaves the hash to the caller, see Renderer::updateState()
+		Routine *routine(const State &state, RoutineCompiler *compiler = nullptr);   // Compiles in the background when given a compiler, see compileRoutine()
+		Routine *fallbackRoutine(const State &state, RoutineCompiler *compiler);   // Reads the blend state at run time, so it's shared by all blend states
 		void setRoutineCacheSize(int routineCacheSize);
 
 		// Shader constants
@@ -320,6 +340,8 @@ namespace sw
 		Factor factor;
 
 	private:
+		static Routine *generate(const State &state, const PixelShader *shader, bool integerPipeline);
+
 		struct UniformBufferInfo
 		{
 			UniformBufferInfo();
@@ -38,6 +38,8 @@ namespace sw
 	{
 		int yMin;
 		int yMax;
+		int xMin;   // Horizontal bounds, used for binning primitives into screen tiles
+		int xMax;
 
 		float4 xQuad;
 		float4 yQuad;
@@ -70,10 +72,10 @@ namespace sw
 		};
 
 		// The rasterizer adds a zero length span to the top and bottom of the polygon to allow
-		// for 2x2 pixel processing. We need an even number of spans to keep accesses aligned.
-		Span outlineUnderflow[2];
-		Span outline[OUTLINE_RESOLUTION];
-		Span outlineOverflow[2];
+		// for 2x2 pixel processing. The spans are stored in an OutlineBuffer, and only the rows
+		// covered by the primitive are backed by memory. Setup receives the start of the storage
+		// and replaces it with a pointer such that outline[y] addresses the span of row y.
+		Span *outline;
 	};
 }
 
@@ -56,14 +56,21 @@ namespace sw
 			Int yMin = *Pointer<Int>(primitive + OFFSET(Primitive,yMin));
 			Int yMax = *Pointer<Int>(primitive + OFFSET(Primitive,yMax));
 
-			Int cluster2 = cluster + cluster;
-			yMin += clusterCount * 2 - 2 - cluster2;
-			yMin &= -clusterCount * 2;
-			yMin += cluster2;
-
-			If(yMin < yMax)
+			if(state.tileRasterization)
 			{
-				rasterize(yMin, yMax);
+				rasterizeTiles(yMin, yMax);
+			}
+			else
+			{
+				Int cluster2 = cluster + cluster;
+				yMin += clusterCount * 2 - 2 - cluster2;
+				yMin &= -clusterCount * 2;
+				yMin += cluster2;
+
+				If(yMin < yMax)
+				{
+					rasterize(yMin, yMax);
+				}
 			}
 
 			primitive += sizeof(Primitive) * state.multiSample;
@@ -90,6 +97,195 @@ namespace sw
 		Return();
 	}
 
+	void QuadRasterizer::rasterizeTiles(Int &yMin, Int &yMax)
+	{
+		// The screen is divided into tiles which are assigned to clusters diagonally, i.e. tile (tx, ty)
+		// belongs to cluster (tx + ty) % clusterCount. Each cluster only visits the tiles it owns within
+		// the primitive's bounding box, so primitives outside of them are rejected without touching any spans.
+		int clusterCount = Renderer::getClusterCount();
+		ASSERT((clusterCount & (clusterCount - 1)) == 0);   // Wraps the tile index with a mask
+
+		Int xMin = *Pointer<Int>(primitive + OFFSET(Primitive,xMin));
+		Int xMax = *Pointer<Int>(primitive + OFFSET(Primitive,xMax));
+
+		yMin &= 0xFFFFFFFE;   // Rasterize pairs of scanlines
+
+		If(yMin < yMax && xMin < xMax)
+		{
+			Int tyMin = yMin >> TILE_SHIFT;
+			Int tyMax = (yMax - 1) >> TILE_SHIFT;
+			Int txMin = xMin >> TILE_SHIFT;
+			Int txMax = (xMax - 1) >> TILE_SHIFT;
+
+			For(Int ty = tyMin, ty <= tyMax, ty++)
+			{
+				Int y0 = Max(yMin, ty << TILE_SHIFT);
+				Int y1 = Min(yMax, (ty + 1) << TILE_SHIFT);
+
+				// First tile of this row owned by the cluster
+				Int tx = txMin + ((cluster - ty - txMin) & (clusterCount - 1));
+
+				For(, tx <= txMax, tx += clusterCount)
+				{
+					tileX0 = tx << TILE_SHIFT;
+					tileX1 = tileX0 + TILE_SIZE;
+
+					if(state.deferredClearTargets || state.deferredClearDepth)
+					{
+						fillClearedTiles(tx, ty);
+					}
+
+					if(state.hiZTest || state.hiZInvalidate)
+					{
+						Pointer<Byte> tile = *Pointer<Pointer<Byte>>(data + OFFSET(DrawData,hiZBuffer)) + (ty * *Pointer<Int>(data + OFFSET(DrawData,hiZPitch)) + tx) * sizeof(float);
+
+						if(state.hiZTest)
+						{
+							hiZRasterize(tile, ty, y0, y1, xMin, xMax);
+						}
+						else
+						{
+							*Pointer<Int>(tile) = Int(0x7F800000);   // +infinity
+							rasterize(y0, y1);
+						}
+					}
+					else
+					{
+						rasterize(y0, y1);
+					}
+				}
+			}
+		}
+	}
+
+	void QuadRasterizer::fillClearedTiles(Int &tx, Int &ty)
+	{
+		for(int index = 0; index < RENDERTARGETS; index++)
+		{
+			if(state.deferredClearTargets & (1 << index))
+			{
+				Pointer<Byte> buffer = *Pointer<Pointer<Byte>>(data + OFFSET(DrawData,colorBuffer[index]));
+				Int pitchB = *Pointer<Int>(data + OFFSET(DrawData,colorPitchB[index]));
+
+				fillClearedTile(data + OFFSET(DrawData,colorClear[index]), buffer, pitchB, Surface::bytes(state.targetFormat[index]), false, tx, ty);
+			}
+		}
+
+		if(state.deferredClearDepth)
+		{
+			Pointer<Byte> buffer = *Pointer<Pointer<Byte>>(data + OFFSET(DrawData,depthBuffer));
+			Int pitchB = *Pointer<Int>(data + OFFSET(DrawData,depthPitchB));
+
+			fillClearedTile(data + OFFSET(DrawData,depthClear), buffer, pitchB, sizeof(float), state.quadLayoutDepthBuffer, tx, ty);
+		}
+	}
+
+	void QuadRasterizer::fillClearedTile(Pointer<Byte> clear, Pointer<Byte> buffer, Int pitchB, int bytes, bool quadLayout, Int &tx, Int &ty)
+	{
+		Pointer<Byte> tile = *Pointer<Pointer<Byte>>(clear + OFFSET(DeferredClear,tiles)) + ty * *Pointer<Int>(clear + OFFSET(DeferredClear,pitch)) + tx;
+
+		If(*Pointer<Byte>(tile) != Byte(0))
+		{
+			*Pointer<Byte>(tile) = Byte(0);
+
+			Int x0 = tx << TILE_SHIFT;
+			Int x1 = Min(x0 + TILE_SIZE, *Pointer<Int>(clear + OFFSET(DeferredClear,width)));
+			Int y0 = ty << TILE_SHIFT;
+			Int y1 = Min(y0 + TILE_SIZE, *Pointer<Int>(clear + OFFSET(DeferredClear,height)));
+
+			Int value = *Pointer<Int>(clear + OFFSET(DeferredClear,value));
+			Int4 value4 = Int4(value);
+
+			// Quad layout buffers store pairs of rows together, but all pixels have the same value
+			int rowStep = quadLayout ? 2 : 1;
+			Int rowBytes = (x1 - x0) * (bytes * rowStep);
+			Pointer<Byte> row = buffer + y0 * pitchB + x0 * (bytes * rowStep);
+
+			For(Int y = y0, y < y1, y += rowStep)
+			{
+				Int i = 0;
+
+				For(, i + 16 <= rowBytes, i += 16)
+				{
+					*Pointer<Int4>(row + i) = value4;
+				}
+
+				For(, i < rowBytes, i += 4)
+				{
+					*Pointer<Int>(row + i) = value;
+				}
+
+				row += pitchB * rowStep;
+			}
+		}
+	}
+
+	void QuadRasterizer::hiZRasterize(Pointer<Byte> &tile, Int &ty, Int &y0, Int &y1, Int &xMin, Int &xMax)
+	{
+		// Bounds of the primitive's depth plane across the part of the tile it can cover. Both
+		// sides get widened by a margin so rounding can't make them tighter than the pixel values.
+		Float A = *Pointer<Float>(primitive + OFFSET(Primitive,z.A));
+		Float B = *Pointer<Float>(primitive + OFFSET(Primitive,z.B));
+		Float C = *Pointer<Float>(primitive + OFFSET(Primitive,z.C));
+
+		Float xa = (Float(Max(xMin, tileX0)) + *Pointer<Float>(primitive + OFFSET(Primitive,xQuad))) * A;
+		Float xb = (Float(Min(xMax, tileX1)) + *Pointer<Float>(primitive + OFFSET(Primitive,xQuad))) * A;
+		Float ya = (Float(y0) + *Pointer<Float>(primitive + OFFSET(Primitive,yQuad))) * B;
+		Float yb = (Float(y1) + *Pointer<Float>(primitive + OFFSET(Primitive,yQuad))) * B;
+
+		Float margin = (Abs(C) + Max(Abs(xa), Abs(xb)) + Max(Abs(ya), Abs(yb))) * Float(1.0f / (1 << 20));
+
+		Float zMin = C + Min(xa, xb) + Min(ya, yb) - margin;
+		Float zMax = C + Max(xa, xb) + Max(ya, yb) + margin;
+
+		if(state.depthClamp)
+		{
+			zMin = Min(Max(zMin, Float(0.0f)), Float(1.0f));
+			zMax = Min(Max(zMax, Float(0.0f)), Float(1.0f));
+		}
+
+		Float tileMax = *Pointer<Float>(tile);
+
+		// Comparisons with NaN are false, so such tiles don't get culled or updated
+		Bool culled = (state.depthCompareMode == DEPTH_LESS) ? (zMin >= tileMax) : (zMin > tileMax);
+
+		If(!culled)
+		{
+			rasterize(y0, y1);
+
+			if(state.hiZUpdate)
+			{
+				// Pixels of a fully covered tile end up with either their old depth or the primitive's, whichever is lower
+				Int tileY0 = ty << TILE_SHIFT;
+				Int tileY1 = Min(tileY0 + TILE_SIZE, *Pointer<Int>(data + OFFSET(DrawData,depthHeight)));
+				Int coverX1 = Min(tileX1, *Pointer<Int>(data + OFFSET(DrawData,depthWidth)));
+
+				If(zMax < tileMax && y0 == tileY0 && y1 >= tileY1 && xMin <= tileX0 && xMax >= coverX1)
+				{
+					Pointer<Byte> outline = *Pointer<Pointer<Byte>>(primitive + OFFSET(Primitive,outline));
+					Bool covered = true;
+
+					For(Int y = y0, y < tileY1, y++)
+					{
+						Int left = Int(*Pointer<Short>(outline + OFFSET(Primitive::Span,left) + y * sizeof(Primitive::Span)));
+						Int right = Int(*Pointer<Short>(outline + OFFSET(Primitive::Span,right) + y * sizeof(Primitive::Span)));
+
+						If(left > tileX0 || right < coverX1)
+						{
+							covered = Bool(false);
+							y = tileY1;
+						}
+					}
+
+					If(covered)
+					{
+						*Pointer<Float>(tile) = zMax;
+					}
+				}
+			}
+		}
+	}
+
 	void QuadRasterizer::rasterize(Int &yMin, Int &yMax)
 	{
 		Pointer<Byte> cBuffer[RENDERTARGETS];
@@ -114,34 +310,47 @@ namespace sw
 			sBuffer = *Pointer<Pointer<Byte>>(data + OFFSET(DrawData,stencilBuffer)) + yMin * *Pointer<Int>(data + OFFSET(DrawData,stencilPitchB));
 		}
 
+		Pointer<Byte> outline[4];
+
+		for(unsigned int q = 0; q < state.multiSample; q++)
+		{
+			outline[q] = *Pointer<Pointer<Byte>>(primitive + q * sizeof(Primitive) + OFFSET(Primitive,outline));
+		}
+
 		Int y = yMin;
 
 		Do
 		{
-			Int x0a = Int(*Pointer<Short>(primitive + OFFSET(Primitive,outline->left) + (y + 0) * sizeof(Primitive::Span)));
-			Int x0b = Int(*Pointer<Short>(primitive + OFFSET(Primitive,outline->left) + (y + 1) * sizeof(Primitive::Span)));
+			Int x0a = Int(*Pointer<Short>(outline[0] + OFFSET(Primitive::Span,left) + (y + 0) * sizeof(Primitive::Span)));
+			Int x0b = Int(*Pointer<Short>(outline[0] + OFFSET(Primitive::Span,left) + (y + 1) * sizeof(Primitive::Span)));
 			Int x0 = Min(x0a, x0b);
 
 			for(unsigned int q = 1; q < state.multiSample; q++)
 			{
-				x0a = Int(*Pointer<Short>(primitive + q * sizeof(Primitive) + OFFSET(Primitive,outline->left) + (y + 0) * sizeof(Primitive::Span)));
-				x0b = Int(*Pointer<Short>(primitive + q * sizeof(Primitive) + OFFSET(Primitive,outline->left) + (y + 1) * sizeof(Primitive::Span)));
+				x0a = Int(*Pointer<Short>(outline[q] + OFFSET(Primitive::Span,left) + (y + 0) * sizeof(Primitive::Span)));
+				x0b = Int(*Pointer<Short>(outline[q] + OFFSET(Primitive::Span,left) + (y + 1) * sizeof(Primitive::Span)));
 				x0 = Min(x0, Min(x0a, x0b));
 			}
 
 			x0 &= 0xFFFFFFFE;
 
-			Int x1a = Int(*Pointer<Short>(primitive + OFFSET(Primitive,outline->right) + (y + 0) * sizeof(Primitive::Span)));
-			Int x1b = Int(*Pointer<Short>(primitive + OFFSET(Primitive,outline->right) + (y + 1) * sizeof(Primitive::Span)));
+			Int x1a = Int(*Pointer<Short>(outline[0] + OFFSET(Primitive::Span,right) + (y + 0) * sizeof(Primitive::Span)));
+			Int x1b = Int(*Pointer<Short>(outline[0] + OFFSET(Primitive::Span,right) + (y + 1) * sizeof(Primitive::Span)));
 			Int x1 = Max(x1a, x1b);
 
 			for(unsigned int q = 1; q < state.multiSample; q++)
 			{
-				x1a = Int(*Pointer<Short>(primitive + q * sizeof(Primitive) + OFFSET(Primitive,outline->right) + (y + 0) * sizeof(Primitive::Span)));
-				x1b = Int(*Pointer<Short>(primitive + q * sizeof(Primitive) + OFFSET(Primitive,outline->right) + (y + 1) * sizeof(Primitive::Span)));
+				x1a = Int(*Pointer<Short>(outline[q] + OFFSET(Primitive::Span,right) + (y + 0) * sizeof(Primitive::Span)));
+				x1b = Int(*Pointer<Short>(outline[q] + OFFSET(Primitive::Span,right) + (y + 1) * sizeof(Primitive::Span)));
 				x1 = Max(x1, Max(x1a, x1b));
 			}
 
+			if(state.tileRasterization)
+			{
+				x0 = Max(x0, tileX0);
+				x1 = Min(x1, tileX1);
+			}
+
 			Float4 yyyy = Float4(Float(y)) + *Pointer<Float4>(primitive + OFFSET(Primitive,yQuad), 16);
 
 			if(interpolateZ())
@@ -269,7 +478,7 @@ namespace sw
 
 				for(unsigned int q = 0; q < state.multiSample; q++)
 				{
-					xLeft[q] = *Pointer<Short4>(primitive + q * sizeof(Primitive) + OFFSET(Primitive,outline) + y * sizeof(Primitive::Span));
+					xLeft[q] = *Pointer<Short4>(outline[q] + y * sizeof(Primitive::Span));
 					xRight[q] = xLeft[q];
 
 					xLeft[q] = Swizzle(xLeft[q], 0xA0) - Short4(1, 2, 1, 2);
@@ -291,7 +500,8 @@ namespace sw
 				}
 			}
 
-			int clusterCount = Renderer::getClusterCount();
+			// Tiles are rasterized by a single cluster, otherwise clusters interleave pairs of scanlines
+			int clusterCount = state.tileRasterization ? 1 : Renderer::getClusterCount();
 
 			for(int index = 0; index < RENDERTARGETS; index++)
 			{
@@ -55,6 +55,14 @@ namespace sw
 
 	private:
 		void rasterize(Int &yMin, Int &yMax);
+		void rasterizeTiles(Int &yMin, Int &yMax);
+		void fillClearedTiles(Int &tx, Int &ty);   // Fills the tile in buffers with a deferred clear, on first access
+		void fillClearedTile(Pointer<Byte> clear, Pointer<Byte> buffer, Int pitchB, int bytes, bool quadLayout, Int &tx, Int &ty);
+		void hiZRasterize(Pointer<Byte> &tile, Int &ty, Int &y0, Int &y1, Int &xMin, Int &xMax);   // Tests and updates the tile's maximum depth
+
+		// Horizontal range of the screen tile being rasterized
+		Int tileX0;
+		Int tileX1;
 	};
 }
 
@@ -15,6 +15,8 @@
 #include "Renderer.hpp"
 
 #include "Clipper.hpp"
+#include "RoutineCompiler.hpp"
+#include "ThreadPool.hpp"
 #include "Surface.hpp"
 #include "Primitive.hpp"
 #include "Polygon.hpp"
@@ -31,6 +33,9 @@
 #include "Common/Timer.hpp"
 #include "Common/Debug.hpp"
 
+#include <climits>
+#include <cmath>
+
 #undef max
 
 bool disableServer = true;
@@ -56,14 +61,20 @@ namespace sw
 	extern bool exactColorRounding;
 	extern TransparencyAntialiasing transparencyAntialiasing;
 	extern bool forceClearRegisters;
+	extern bool tileRasterization;
 
 	extern bool precacheVertex;
 	extern bool precacheSetup;
 	extern bool precachePixel;
-
-	static const int batchSize = 128;
-	AtomicInt threadCount(1);
-	AtomicInt Renderer::unitCount(1);
+	extern std::string precacheDirectory;
+	extern int tierUpThreshold;
+	extern int vertexCacheSize;
+	extern int vertexCacheAssociativity;
+	extern bool positionOnlyCulling;
+	extern bool guardBandClipping;
+
+	static const int maxBatchSize = 128;   // Primitives per task, sizes the per-unit triangle and primitive buffers
+	static const float maxGuardBandArea = 4194304.0f;   // In pixels, keeps the setup routine's fixed-point edge arithmetic within 32 bits
 	AtomicInt Renderer::clusterCount(1);
 
 	TranscendentalPrecision logPrecision = ACCURATE;
@@ -72,21 +83,45 @@ namespace sw
 	TranscendentalPrecision rsqPrecision = ACCURATE;
 	bool perspectiveCorrection = true;
 
-	struct Parameters
+	// Float constants are tracked in blocks, so scattered updates don't dirty all the registers in between
+	static const int constantBlockShift = 4;
+	static const unsigned int vsConstantBlocks = (VERTEX_UNIFORM_VECTORS + 1 + (1 << constantBlockShift) - 1) >> constantBlockShift;
+	static const unsigned int psConstantBlocks = (FRAGMENT_UNIFORM_VECTORS + (1 << constantBlockShift) - 1) >> constantBlockShift;
+	static_assert(vsConstantBlocks < 32 && psConstantBlocks < 32, "Dirty constant blocks must fit a mask");
+
+	static void copyDirtyConstants(float4 *destination, const float4 *source, unsigned int dirtyBlocks, unsigned int count)
 	{
-		Renderer *renderer;
-		int threadIndex;
-	};
+		unsigned int block = 0;
+
+		while(dirtyBlocks >> block)
+		{
+			if(!(dirtyBlocks & (1 << block)))
+			{
+				block++;
+				continue;
+			}
+
+			unsigned int begin = block << constantBlockShift;
+
+			while(dirtyBlocks & (1 << block))   // Copy adjacent blocks at once
+			{
+				block++;
+			}
+
+			unsigned int end = min(block << constantBlockShift, count);
+			memcpy(&destination[begin], &source[begin], sizeof(float4) * (end - begin));
+		}
+	}
 
 	DrawCall::DrawCall()
 	{
 		queries = 0;
 
-		vsDirtyConstF = VERTEX_UNIFORM_VECTORS + 1;
+		vsDirtyConstF = (1 << vsConstantBlocks) - 1;
 		vsDirtyConstI = 16;
 		vsDirtyConstB = 16;
 
-		psDirtyConstF = FRAGMENT_UNIFORM_VECTORS;
+		psDirtyConstF = (1 << psConstantBlocks) - 1;
 		psDirtyConstI = 16;
 		psDirtyConstB = 16;
 
@@ -117,6 +152,9 @@ namespace sw
 		setRenderTarget(0, 0);
 		clipper = new Clipper(symmetricNormalizedDepth);
 		blitter = new Blitter;
+		routineCompiler = nullptr;
+		routineStatesValid = false;
+		pixelFallback = nullptr;
 
 		updateViewMatrix = true;
 		updateBaseMatrix = true;
@@ -130,25 +168,27 @@ namespace sw
 		for(int i = 0; i < 16; i++)
 		{
 			vertexTask[i] = 0;
-
-			worker[i] = 0;
-			resume[i] = 0;
+			slotActive[i] = false;
 			suspend[i] = 0;
 		}
 
+		threadPool = nullptr;
+		threadCount = 1;
+		threadAffinity = ThreadPool::AFFINITY_NONE;
+		unitCount = 1;
 		threadsAwake = 0;
 		resumeApp = new Event();
 
 		currentDraw = 0;
 		nextDraw = 0;
 
-		qHead = 0;
 		qSize = 0;
 
 		for(int i = 0; i < 16; i++)
 		{
 			triangleBatch[i] = 0;
 			primitiveBatch[i] = 0;
+			outlineBuffer[i] = 0;
 		}
 
 		for(int draw = 0; draw < DRAW_COUNT; draw++)
@@ -185,6 +225,9 @@ namespace sw
 		delete blitter;
 		blitter = nullptr;
 
+		delete routineCompiler;
+		routineCompiler = nullptr;
+
 		terminateThreads();
 		delete resumeApp;
 
@@ -196,6 +239,15 @@ namespace sw
 		delete swiftConfig;
 	}
 
+	void DeferredClear::set(Surface *surface)
+	{
+		tiles = surface->getClearTiles();
+		pitch = surface->getTilePitch();
+		value = surface->getClearValue();
+		width = align(surface->getWidth(), 2);
+		height = align(surface->getHeight(), 2);
+	}
+
 	// This object has to be mem aligned
 	void* Renderer::operator new(size_t size)
 	{
@@ -208,7 +260,7 @@ namespace sw
 		sw::deallocate(mem);
 	}
 
-	void Renderer::draw(DrawType drawType, unsigned int indexOffset, unsigned int count, bool update)
+	void Renderer::draw(DrawType drawType, unsigned int indexOffset, unsigned int count, unsigned int instanceCount, bool update)
 	{
 		#ifndef NDEBUG
 			if(count < minPrimitives || count > maxPrimitives)
@@ -217,6 +269,12 @@ namespace sw
 			}
 		#endif
 
+		if((uint64_t)count * instanceCount > INT_MAX)
+		{
+			ASSERT(false);   // Primitive counts and task references of all instances are ints
+			return;
+		}
+
 		context->drawType = drawType;
 
 		updateConfiguration();
@@ -239,16 +297,55 @@ namespace sw
 
 			if(update || oldMultiSampleMask != context->multiSampleMask)
 			{
-				vertexState = VertexProcessor::update(drawType);
-				setupState = SetupProcessor::update();
-				pixelState = PixelProcessor::update();
+				// Draws which didn't change any state keep using the same routines without hashing the states or querying the caches
+				bool routinesChanged = updateState(vertexState, VertexProcessor::update(drawType), routineStatesValid);
+				routinesChanged |= updateState(setupState, SetupProcessor::update(), routineStatesValid);
+				routinesChanged |= updateState(pixelState, PixelProcessor::update(), routineStatesValid);
+				routinesChanged |= !routineStatesValid || routineClipFlags != clipFlags;
+
+				if(routinesChanged)
+				{
+					RoutineCompiler *compiler = routineCompiler;
+
+					#ifndef NDEBUG
+					if(threadCount == 1)   // The main thread executes the draw and can't wait for routines
+					{
+						compiler = nullptr;
+					}
+					#endif
+
+					vertexRoutine = VertexProcessor::routine(vertexState, compiler);
+					positionRoutine = nullptr;
 
-				vertexRoutine = VertexProcessor::routine(vertexState);
-				setupRoutine = SetupProcessor::routine(setupState);
-				pixelRoutine = PixelProcessor::routine(pixelState);
+					// Shade only the positions first when triangles may get culled and there are other outputs to skip
+					if(positionOnlyCulling && context->isDrawTriangle() && context->fillMode == FILL_SOLID &&
+					   setupState.cullMode != CULL_NONE && !setupState.rasterizerDiscard &&
+					   !vertexState.transformFeedbackEnabled && VertexProcessor::hasVaryings(vertexState))
+					{
+						positionRoutine = VertexProcessor::routine(VertexProcessor::positionOnlyState(vertexState), compiler);
+					}
+
+					setupRoutine = SetupProcessor::routine(setupState, compiler);
+					clipRoutine = SetupProcessor::clipRoutine(clipFlags, compiler);
+					pixelRoutine = PixelProcessor::routine(pixelState, compiler);
+					pixelFallback = nullptr;
+
+					// Blend state changes are frequent, so shade with a routine that reads it from the draw data until the specialized one is ready
+					if(compiler && !pixelRoutine->getEntry())
+					{
+						pixelFallback = PixelProcessor::fallbackRoutine(pixelState, compiler);
+					}
+
+					routineClipFlags = clipFlags;
+					routineStatesValid = true;
+				}
+				else if(pixelFallback && pixelRoutine->getEntry())
+				{
+					pixelFallback = nullptr;
+				}
 			}
 
-			int batch = batchSize / ms;
+			int batch = max(primitiveBatchSize((uint64_t)count * instanceCount) / ms, 1);
 
 			int (Renderer::*setupPrimitives)(int batch, int count);
 
@@ -324,13 +421,29 @@ namespace sw
 
 			vertexRoutine->bind();
 			setupRoutine->bind();
+			clipRoutine->bind();
 			pixelRoutine->bind();
 
+			if(positionRoutine)
+			{
+				positionRoutine->bind();
+			}
+
+			if(pixelFallback)
+			{
+				pixelFallback->bind();
+			}
+
 			draw->vertexRoutine = vertexRoutine;
+			draw->positionRoutine = positionRoutine;
 			draw->setupRoutine = setupRoutine;
+			draw->clipRoutine = clipRoutine;
 			draw->pixelRoutine = pixelRoutine;
+			draw->pixelFallback = pixelFallback;
 			draw->vertexPointer = (VertexProcessor::RoutinePointer)vertexRoutine->getEntry();
+			draw->positionPointer = positionRoutine ? (VertexProcessor::RoutinePointer)positionRoutine->getEntry() : nullptr;
 			draw->setupPointer = (SetupProcessor::RoutinePointer)setupRoutine->getEntry();
+			draw->clipPointer = (SetupProcessor::ClipPointer)clipRoutine->getEntry();
 			draw->pixelPointer = (PixelProcessor::RoutinePointer)pixelRoutine->getEntry();
 			draw->setupPrimitives = setupPrimitives;
 			draw->setupState = setupState;
@@ -340,6 +453,7 @@ namespace sw
 				draw->vertexStream[i] = context->input[i].resource;
 				data->input[i] = context->input[i].buffer;
 				data->stride[i] = context->input[i].stride;
+				data->divisor[i] = context->input[i].divisor;
 
 				if(draw->vertexStream[i])
 				{
@@ -364,7 +478,23 @@ namespace sw
 				if(pixelState.sampler[sampler].textureType != TEXTURE_NULL)
 				{
 					draw->texture[sampler] = context->texture[sampler];
-					draw->texture[sampler]->lock(PUBLIC, isReadWriteTexture(sampler) ? MANAGED : PRIVATE);   // If the texure is both read and written, use the same read/write lock as render targets
+
+					if(isReadWriteTexture(sampler))
+					{
+						if(context->sampler[sampler].hasDeferredClears())
+						{
+							draw->texture[sampler]->lock(PUBLIC);   // Wait for draws which might still be filling tiles
+							context->sampler[sampler].resolveDeferredClears();
+							draw->texture[sampler]->unlock();
+						}
+
+						draw->texture[sampler]->lock(PUBLIC, MANAGED);   // Use the same read/write lock as render targets
+					}
+					else
+					{
+						draw->texture[sampler]->lock(PUBLIC, PRIVATE);   // Waits for draws to it, so they're done filling cleared tiles
+						context->sampler[sampler].resolveDeferredClears();
+					}
 
 					data->mipmap[sampler] = context->sampler[sampler].getTextureData();
 				}
@@ -374,8 +504,12 @@ namespace sw
 			{
 				if(draw->psDirtyConstF)
 				{
-					memcpy(&data->ps.cW, PixelProcessor::cW, sizeof(word4) * 4 * (draw->psDirtyConstF < 8 ? draw->psDirtyConstF : 8));
-					memcpy(&data->ps.c, PixelProcessor::c, sizeof(float4) * draw->psDirtyConstF);
+					if(draw->psDirtyConstF & 1)   // The first block holds the fixed-point copies of c0-c7
+					{
+						memcpy(&data->ps.cW, PixelProcessor::cW, sizeof(word4) * 4 * 8);
+					}
+
+					copyDirtyConstants(data->ps.c, PixelProcessor::c, draw->psDirtyConstF, FRAGMENT_UNIFORM_VECTORS);
 					draw->psDirtyConstF = 0;
 				}
 
@@ -423,6 +557,7 @@ namespace sw
 						{
 							draw->texture[TEXTURE_IMAGE_UNITS + sampler] = context->texture[TEXTURE_IMAGE_UNITS + sampler];
 							draw->texture[TEXTURE_IMAGE_UNITS + sampler]->lock(PUBLIC, PRIVATE);
+							context->sampler[TEXTURE_IMAGE_UNITS + sampler].resolveDeferredClears();
 
 							data->mipmap[TEXTURE_IMAGE_UNITS + sampler] = context->sampler[TEXTURE_IMAGE_UNITS + sampler].getTextureData();
 						}
@@ -431,7 +566,7 @@ namespace sw
 
 				if(draw->vsDirtyConstF)
 				{
-					memcpy(&data->vs.c, VertexProcessor::c, sizeof(float4) * draw->vsDirtyConstF);
+					copyDirtyConstants(data->vs.c, VertexProcessor::c, draw->vsDirtyConstF, VERTEX_UNIFORM_VECTORS + 1);
 					draw->vsDirtyConstF = 0;
 				}
 
@@ -447,11 +582,6 @@ namespace sw
 					draw->vsDirtyConstB = 0;
 				}
 
-				if(context->vertexShader->isInstanceIdDeclared())
-				{
-					data->instanceID = context->instanceID;
-				}
-
 				VertexProcessor::lockUniformBuffers(data->vs.u, draw->vUniformBuffers);
 				VertexProcessor::lockTransformFeedbackBuffers(data->vs.t, data->vs.reg, data->vs.row, data->vs.col, data->vs.str, draw->transformFeedbackBuffers);
 			}
@@ -459,7 +589,7 @@ namespace sw
 			{
 				data->ff = ff;
 
-				draw->vsDirtyConstF = VERTEX_UNIFORM_VECTORS + 1;
+				draw->vsDirtyConstF = (1 << vsConstantBlocks) - 1;
 				draw->vsDirtyConstI = 16;
 				draw->vsDirtyConstB = 16;
 
@@ -494,6 +624,17 @@ namespace sw
 
 			data->factor = factor;
 
+			if(pixelFallback)
+			{
+				data->blend.alphaBlendActive = pixelState.alphaBlendActive;
+				data->blend.sourceBlendFactor = pixelState.sourceBlendFactor;
+				data->blend.destBlendFactor = pixelState.destBlendFactor;
+				data->blend.blendOperation = pixelState.blendOperation;
+				data->blend.sourceBlendFactorAlpha = pixelState.sourceBlendFactorAlpha;
+				data->blend.destBlendFactorAlpha = pixelState.destBlendFactorAlpha;
+				data->blend.blendOperationAlpha = pixelState.blendOperationAlpha;
+			}
+
 			if(pixelState.transparencyAntialiasing == TRANSPARENCY_ALPHA_TO_COVERAGE)
 			{
 				float ref = context->alphaReference * (1.0f / 255.0f);
@@ -530,6 +671,12 @@ namespace sw
 						data->cycles[i][cluster] = 0;
 					}
 				}
+
+				for(int unit = 0; unit < unitCount; unit++)
+				{
+					data->vertexCacheHits[unit] = 0;
+					data->vertexCacheMisses[unit] = 0;
+				}
 			#endif
 
 			// Viewport
@@ -587,6 +734,14 @@ namespace sw
 				data->depthNear = N;
 				draw->clipFlags = clipFlags;
 
+				// Guard band with the viewport's aspect ratio and maxGuardBandArea pixels, which is only
+				// worth using when it's larger than the viewport itself
+				float area = abs(viewport.width * viewport.height);
+				float guardBand = (area > 0.0f) ? sqrt(maxGuardBandArea / area) : 1.0f;
+
+				data->guardBand = replicate(guardBand);
+				draw->guardBand = guardBandClipping && draw->setupPrimitives == &Renderer::setupSolidTriangles && guardBand > 1.0f;
+
 				if(clipFlags)
 				{
 					if(clipFlags & Clipper::CLIP_PLANE0) data->clipPlane[0] = clipPlane[0];
@@ -611,6 +766,11 @@ namespace sw
 						data->colorBuffer[index] += q * ms * context->renderTarget[index]->getSliceB(true);
 						data->colorPitchB[index] = context->renderTarget[index]->getInternalPitchB();
 						data->colorSliceB[index] = context->renderTarget[index]->getInternalSliceB();
+
+						if(pixelState.deferredClearTargets & (1 << index))
+						{
+							data->colorClear[index].set(context->renderTarget[index]);
+						}
 					}
 				}
 
@@ -624,6 +784,25 @@ namespace sw
 					data->depthBuffer += q * ms * context->depthBuffer->getSliceB(true);
 					data->depthPitchB = context->depthBuffer->getInternalPitchB();
 					data->depthSliceB = context->depthBuffer->getInternalSliceB();
+
+					if(pixelState.deferredClearDepth)
+					{
+						data->depthClear.set(context->depthBuffer);
+					}
+
+					if(pixelState.hiZTest || pixelState.hiZInvalidate)
+					{
+						data->hiZBuffer = context->depthBuffer->getHiZ();
+						data->hiZPitch = context->depthBuffer->getTilePitch();
+						data->depthWidth = context->depthBuffer->getWidth();
+						data->depthHeight = context->depthBuffer->getHeight();
+
+						// Without tile rasterization draws aren't ordered per tile, so the whole buffer gets invalidated up front
+						if(pixelState.hiZInvalidate && !pixelState.tileRasterization)
+						{
+							context->depthBuffer->invalidateHiZ();
+						}
+					}
 				}
 
 				if(draw->stencilBuffer)
@@ -638,16 +817,30 @@ namespace sw
 
 			// Scissor
 			{
-				data->scissorX0 = scissor.x0;
-				data->scissorX1 = scissor.x1;
-				data->scissorY0 = scissor.y0;
-				data->scissorY1 = scissor.y1;
+				Rect clipRect = scissor;
+
+				if(draw->guardBand)   // Triangles aren't clipped to the viewport's sides
+				{
+					float y0 = min(viewport.y0, viewport.y0 + viewport.height);
+					float y1 = max(viewport.y0, viewport.y0 + viewport.height);
+
+					// Pixels with their center inside the viewport
+					clipRect.clip((int)ceil(viewport.x0 - 0.5f), (int)ceil(y0 - 0.5f), (int)ceil(viewport.x0 + viewport.width - 0.5f), (int)ceil(y1 - 0.5f));
+				}
+
+				data->scissorX0 = clipRect.x0;
+				data->scissorX1 = clipRect.x1;
+				data->scissorY0 = clipRect.y0;
+				data->scissorY1 = clipRect.y1;
 			}
 
+			// All instances are processed as one continuous range of primitives, with batches
+			// split at instance boundaries so each one is shaded with a single instance ID.
 			draw->primitive = 0;
-			draw->count = count;
+			draw->count = count * instanceCount;
+			draw->instancePrimitives = count;
 
-			draw->references = (count + batch - 1) / batch;
+			draw->references = ((count + batch - 1) / batch) * instanceCount;
 
 			schedulerMutex.lock();
 			++nextDraw; // Atomic
@@ -664,19 +857,59 @@ namespace sw
 			else
 			#endif
 			{
-				if(!threadsAwake)
-				{
-					suspend[0]->wait();
+				resumeThreads();
+			}
+		}
+	}
 
-					threadsAwake = 1;
-					task[0].type = Task::RESUME;
+	void Renderer::resumeThreads()
+	{
+		// Threads which found the routines missing suspend while holding the scheduler lock,
+		// so after taking it they are either counted as asleep or will see the new routine.
+		LockGuard lock(schedulerMutex);
 
-					resume[0]->signal();
-				}
-			}
+		if(!threadsAwake)
+		{
+			threadsAwake = 1;
+			resumeSlot(0);
+		}
+	}
+
+	void Renderer::resumeSlot(int threadIndex)
+	{
+		// A slot whose job hasn't returned yet sees the new task type and keeps running.
+		// Otherwise it gets a new job, so resuming never waits for a pool thread.
+		task[threadIndex].type = Task::RESUME;
+
+		if(!slotActive[threadIndex])
+		{
+			slotActive[threadIndex] = true;
+			threadPool->submit(runTasks, this, threadIndex);
 		}
 	}
 
+	bool Renderer::suspendSlot(int threadIndex)
+	{
+		schedulerMutex.lock();
+
+		bool suspended = task[threadIndex].type == Task::SUSPEND;
+
+		if(suspended)
+		{
+			slotActive[threadIndex] = false;
+			suspend[threadIndex]->signal();
+		}
+
+		schedulerMutex.unlock();   // Can be terminated from here on, so don't touch any members after this
+
+		return suspended;
+	}
+
+	void Renderer::routineCompiled(void *parameters)
+	{
+		static_cast<Renderer*>(parameters)->resumeThreads();
+	}
+
 	void Renderer::clear(void *value, Format format, Surface *dest, const Rect &clearRect, unsigned int rgbaMask)
 	{
 		blitter->clear(value, format, dest, clearRect, rgbaMask);
@@ -692,29 +925,35 @@ namespace sw
 		blitter->blit3D(source, dest);
 	}
 
-	void Renderer::threadFunction(void *parameters)
+	bool Renderer::runTasks(void *parameters, int threadIndex)
 	{
-		Renderer *renderer = static_cast<Parameters*>(parameters)->renderer;
-		int threadIndex = static_cast<Parameters*>(parameters)->threadIndex;
-
-		if(logPrecision < IEEE)
-		{
-			CPUID::setFlushToZero(true);
-			CPUID::setDenormalsAreZero(true);
-		}
-
-		renderer->threadLoop(threadIndex);
+		return static_cast<Renderer*>(parameters)->runTasks(threadIndex);
 	}
 
-	void Renderer::threadLoop(int threadIndex)
+	bool Renderer::runTasks(int threadIndex)
 	{
-		while(!exitThreads)
+		// Pool threads are shared with other Renderers, so set the floating-point mode for each run
+		CPUID::setFlushToZero(logPrecision < IEEE);
+		CPUID::setDenormalsAreZero(logPrecision < IEEE);
+
+		for(int i = 0; i < TASK_QUANTUM; i++)
 		{
-			taskLoop(threadIndex);
+			if(task[threadIndex].type == Task::SUSPEND && suspendSlot(threadIndex))
+			{
+				return true;
+			}
 
-			suspend[threadIndex]->signal();
-			resume[threadIndex]->wait();
+			scheduleTask(threadIndex);
+			executeTask(threadIndex);
+		}
+
+		// A suspended slot must not stay queued, or nothing could resume it until its turn
+		if(task[threadIndex].type == Task::SUSPEND && suspendSlot(threadIndex))
+		{
+			return true;
 		}
+
+		return false;   // Still awake, continue after other queued jobs
 	}
 
 	void Renderer::taskLoop(int threadIndex)
@@ -726,8 +965,11 @@ namespace sw
 		}
 	}
 
-	void Renderer::findAvailableTasks()
+	void Renderer::findAvailableTasks(int threadIndex)
 	{
+		WorkStealingQueue<Task, TASK_COUNT> &queue = taskQueue[threadIndex];
+		Task task;
+
 		// Find pixel tasks
 		for(int cluster = 0; cluster < clusterCount; cluster++)
 		{
@@ -741,16 +983,22 @@ namespace sw
 						{
 							if(pixelProgress[cluster].processedPrimitives == primitiveProgress[unit].firstPrimitive)   // Previous primitives have been rendered
 							{
-								Task &task = taskQueue[qHead];
 								task.type = Task::PIXELS;
 								task.primitiveUnit = unit;
 								task.pixelCluster = cluster;
 
 								pixelProgress[cluster].executing = true;
 
-								// Commit to the task queue
-								qHead = (qHead + 1) & TASK_COUNT_BITS;
-								qSize++;
+								// Publish the task to the other threads. When the queue is full
+								// the task stays unclaimed and gets found by a later search.
+								if(queue.push(task))
+								{
+									qSize++;
+								}
+								else
+								{
+									pixelProgress[cluster].executing = false;
+								}
 
 								break;
 							}
@@ -785,47 +1033,133 @@ namespace sw
 				draw = drawList[currentDraw & DRAW_COUNT_BITS];
 			}
 
+			if(!routinesReady(draw))
+			{
+				return;   // Scheduling resumes when the routines have been compiled
+			}
+
+			if(queue.full())
+			{
+				return;   // Claim more primitives once the published tasks have been taken
+			}
+
 			if(!primitiveProgress[unit].references)   // Task not already being executed and not still in use by a pixel unit
 			{
 				primitive = draw->primitive;
 				count = draw->count;
 				int batch = draw->batchSize;
+				int instanceEnd = (primitive / draw->instancePrimitives + 1) * draw->instancePrimitives;
 
 				primitiveProgress[unit].drawCall = currentDraw;
 				primitiveProgress[unit].firstPrimitive = primitive;
-				primitiveProgress[unit].primitiveCount = count - primitive >= batch ? batch : count - primitive;
+				primitiveProgress[unit].primitiveCount = instanceEnd - primitive >= batch ? batch : instanceEnd - primitive;
 
-				draw->primitive += batch;
+				draw->primitive += primitiveProgress[unit].primitiveCount;
 
-				Task &task = taskQueue[qHead];
 				task.type = Task::PRIMITIVES;
 				task.primitiveUnit = unit;
 
 				primitiveProgress[unit].references = -1;
 
-				// Commit to the task queue
-				qHead = (qHead + 1) & TASK_COUNT_BITS;
+				// Publish the task to the other threads, there's room since only this thread pushes
+				queue.push(task);
 				qSize++;
 			}
 		}
 	}
 
-	void Renderer::scheduleTask(int threadIndex)
+	int Renderer::primitiveBatchSize(uint64_t count) const
 	{
-		schedulerMutex.lock();
+		if(threadCount == 1)
+		{
+			return maxBatchSize;   // Splitting the draw only adds task overhead
+		}
 
-		int curThreadsAwake = threadsAwake;
+		// Aim for a few batches per thread, so small draws occupy all threads and the
+		// load evens out, but keep enough vertex shading per batch to amortize the
+		// overhead of scheduling it. Costlier vertex shaders make smaller batches pay off.
+		int shaderCost = context->vertexShader ? (int)context->vertexShader->getLength() : 32;
+		int minBatch = clamp(1024 / max(shaderCost, 1), 4, 32);
+		uint64_t batches = 4 * threadCount;
+		int batch = (int)min((count + batches - 1) / batches, (uint64_t)maxBatchSize);
 
-		if((int)qSize < threadCount - curThreadsAwake + 1)
+		return clamp(batch, minBatch, maxBatchSize);
+	}
+
+	bool Renderer::routinesReady(DrawCall *draw)
+	{
+		if(!draw->vertexPointer) draw->vertexPointer = (VertexProcessor::RoutinePointer)draw->vertexRoutine->getEntry();
+		if(!draw->setupPointer) draw->setupPointer = (SetupProcessor::RoutinePointer)draw->setupRoutine->getEntry();
+		if(!draw->clipPointer) draw->clipPointer = (SetupProcessor::ClipPointer)draw->clipRoutine->getEntry();
+		if(!draw->pixelPointer) draw->pixelPointer = (PixelProcessor::RoutinePointer)draw->pixelRoutine->getEntry();
+		if(!draw->pixelPointer && draw->pixelFallback) draw->pixelPointer = (PixelProcessor::RoutinePointer)draw->pixelFallback->getEntry();
+
+		if(draw->positionRoutine && !draw->positionPointer)
 		{
-			findAvailableTasks();
+			draw->positionPointer = (VertexProcessor::RoutinePointer)draw->positionRoutine->getEntry();
+
+			if(!draw->positionPointer)
+			{
+				return false;
+			}
 		}
 
-		if(qSize != 0)
+		return draw->vertexPointer && draw->setupPointer && draw->clipPointer && draw->pixelPointer;
+	}
+
+	bool Renderer::takeTask(int threadIndex)
+	{
+		Task newTask;
+
+		// Take from our own queue first, then steal from the other threads
+		for(int i = 0; i < threadCount; i++)
+		{
+			int victim = (threadIndex + i) % threadCount;
+
+			if(taskQueue[victim].take(newTask))
+			{
+				task[threadIndex] = newTask;
+				qSize--;
+
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void Renderer::scheduleTask(int threadIndex)
+	{
+		// Tasks published by other threads can be taken without holding the scheduler lock.
+		// The lock is only needed to discover new tasks, which updates the shared progress.
+		if(takeTask(threadIndex))
+		{
+			return;
+		}
+
+		for(int spin = 0; !schedulerMutex.attemptLock(); spin++)
 		{
-			task[threadIndex] = taskQueue[(qHead - qSize) & TASK_COUNT_BITS];
-			qSize--;
+			// Another thread is looking for tasks. Take them as soon as they're published.
+			if(takeTask(threadIndex))
+			{
+				return;
+			}
+
+			if(spin == SCHEDULER_SPINS)
+			{
+				schedulerMutex.lock();   // Nothing got published, so wait instead of burning CPU
+				break;
+			}
 
+			Thread::yield();
+		}
+
+		int curThreadsAwake = threadsAwake;
+
+		findAvailableTasks(threadIndex);
+
+		if(takeTask(threadIndex))
+		{
 			if(curThreadsAwake != threadCount)
 			{
 				int wakeup = qSize - curThreadsAwake + 1;
@@ -834,9 +1168,7 @@ namespace sw
 				{
 					if(task[i].type == Task::SUSPEND)
 					{
-						suspend[i]->wait();
-						task[i].type = Task::RESUME;
-						resume[i]->signal();
+						resumeSlot(i);
 
 						++threadsAwake; // Atomic
 						wakeup--;
@@ -871,7 +1203,7 @@ namespace sw
 				DrawCall *draw = drawList[primitiveProgress[unit].drawCall & DRAW_COUNT_BITS];
 				int (Renderer::*setupPrimitives)(int batch, int count) = draw->setupPrimitives;
 
-				processPrimitiveVertices(unit, input, count, draw->count, threadIndex);
+				count = processPrimitiveVertices(unit, input, count, draw->instancePrimitives, threadIndex);
 
 				#if PERF_HUD
 					int64_t time = Timer::ticks();
@@ -883,6 +1215,7 @@ namespace sw
 
 				if(!draw->setupState.rasterizerDiscard)
 				{
+					outlineBuffer[unit]->reset();
 					visible = (this->*setupPrimitives)(unit, count);
 				}
 
@@ -967,6 +1300,12 @@ namespace sw
 							profiler.cycles[i] += data.cycles[i][cluster];
 						}
 					}
+
+					for(int unit = 0; unit < unitCount; unit++)
+					{
+						profiler.vertexCacheHits += data.vertexCacheHits[unit];
+						profiler.vertexCacheMisses += data.vertexCacheMisses[unit];
+					}
 				#endif
 
 				if(draw.queries)
@@ -1056,8 +1395,19 @@ namespace sw
 
 				draw.vertexRoutine->unbind();
 				draw.setupRoutine->unbind();
+				draw.clipRoutine->unbind();
 				draw.pixelRoutine->unbind();
 
+				if(draw.positionRoutine)
+				{
+					draw.positionRoutine->unbind();
+				}
+
+				if(draw.pixelFallback)
+				{
+					draw.pixelFallback->unbind();
+				}
+
 				sync->unlock();
 
 				draw.references = -1;
@@ -1068,7 +1418,7 @@ namespace sw
 		pixelProgress[cluster].executing = false;
 	}
 
-	void Renderer::processPrimitiveVertices(int unit, unsigned int start, unsigned int triangleCount, unsigned int loop, int thread)
+	int Renderer::processPrimitiveVertices(int unit, unsigned int start, unsigned int triangleCount, unsigned int loop, int thread)
 	{
 		Triangle *triangle = triangleBatch[unit];
 		int primitiveDrawCall = primitiveProgress[unit].drawCall;
@@ -1079,13 +1429,20 @@ namespace sw
 		const void *indices = data->indices;
 		VertexProcessor::RoutinePointer vertexRoutine = draw->vertexPointer;
 
-		if(task->vertexCache.drawCall != primitiveDrawCall)
+		// Batches don't straddle instances, so the whole batch uses the same instance ID
+		unsigned int instanceID = start / loop;
+		unsigned int primitiveStart = start;
+		start -= instanceID * loop;
+
+		if(task->vertexCache.drawCall != primitiveDrawCall || task->instanceID != instanceID)
 		{
 			task->vertexCache.clear();
 			task->vertexCache.drawCall = primitiveDrawCall;
+			task->positionCache.clear();
+			task->instanceID = instanceID;
 		}
 
-		unsigned int batch[128][3];   // FIXME: Adjust to dynamic batch size
+		unsigned int batch[maxBatchSize][3];
 
 		switch(draw->drawType)
 		{
@@ -1507,12 +1864,94 @@ namespace sw
 			break;
 		default:
 			ASSERT(false);
-			return;
+			return 0;
+		}
+
+		task->primitiveStart = primitiveStart;
+
+		if(draw->positionPointer)
+		{
+			triangleCount = cullTriangles(unit, batch, triangleCount, thread);
+
+			if(triangleCount == 0)
+			{
+				return 0;
+			}
 		}
 
-		task->primitiveStart = start;
 		task->vertexCount = triangleCount * 3;
 		vertexRoutine(&triangle->v0, (unsigned int*)&batch, task, data);
+
+		#if PERF_PROFILE
+			data->vertexCacheHits[unit] += task->vertexCount - task->vertexCache.misses;
+			data->vertexCacheMisses[unit] += task->vertexCache.misses;
+		#endif
+
+		return triangleCount;
+	}
+
+	unsigned int Renderer::cullTriangles(int unit, unsigned int (*batch)[3], unsigned int triangleCount, int thread)
+	{
+		Triangle *triangle = triangleBatch[unit];
+		DrawCall *draw = drawList[primitiveProgress[unit].drawCall & DRAW_COUNT_BITS];
+		VertexTask *task = vertexTask[thread];
+
+		task->vertexCount = triangleCount * 3;
+		draw->positionPointer(&triangle->v0, (unsigned int*)batch, task, draw->data);
+
+		const SetupProcessor::State &state = draw->setupState;
+		int pos = state.positionRegister;
+		unsigned int visible = 0;
+
+		// Keep only the triangles which setupSolidTriangles() wouldn't reject
+		for(unsigned int i = 0; i < triangleCount; i++)
+		{
+			const Vertex &v0 = triangle[i].v0;
+			const Vertex &v1 = triangle[i].v1;
+			const Vertex &v2 = triangle[i].v2;
+
+			if((v0.clipFlags & v1.clipFlags & v2.clipFlags & ~Clipper::CLIP_GUARDBAND) != Clipper::CLIP_FINITE)
+			{
+				continue;
+			}
+
+			if(Clipper::clipFlagsOr(v0.clipFlags | v1.clipFlags | v2.clipFlags, *draw) == Clipper::CLIP_FINITE)   // Not clipped
+			{
+				// Same arithmetic as the setup routine, so culling matches exactly
+				float x0 = (float)v0.X;
+				float x1 = (float)v1.X;
+				float x2 = (float)v2.X;
+
+				float y0 = (float)v0.Y;
+				float y1 = (float)v1.Y;
+				float y2 = (float)v2.Y;
+
+				float A = (y2 - y0) * x1 + (y1 - y2) * x0 + (y0 - y1) * x2;   // Area
+
+				if(A == 0.0f)
+				{
+					continue;
+				}
+
+				if(std::signbit(v0.v[pos].w) ^ std::signbit(v1.v[pos].w) ^ std::signbit(v2.v[pos].w))
+				{
+					A = -A;
+				}
+
+				if((state.cullMode == CULL_CLOCKWISE && A >= 0.0f) ||
+				   (state.cullMode == CULL_COUNTERCLOCKWISE && A <= 0.0f))
+				{
+					continue;
+				}
+			}
+
+			batch[visible][0] = batch[i][0];
+			batch[visible][1] = batch[i][1];
+			batch[visible][2] = batch[i][2];
+			visible++;
+		}
+
+		return visible;
 	}
 
 	int Renderer::setupSolidTriangles(int unit, int count)
@@ -1522,11 +1961,9 @@ namespace sw
 
 		DrawCall &draw = *drawList[primitiveProgress[unit].drawCall & DRAW_COUNT_BITS];
 		SetupProcessor::State &state = draw.setupState;
-		const SetupProcessor::RoutinePointer &setupRoutine = draw.setupPointer;
 
 		int ms = state.multiSample;
 		int pos = state.positionRegister;
-		const DrawData *data = draw.data;
 		int visible = 0;
 
 		for(int i = 0; i < count; i++, triangle++)
@@ -1535,21 +1972,21 @@ namespace sw
 			Vertex &v1 = triangle->v1;
 			Vertex &v2 = triangle->v2;
 
-			if((v0.clipFlags & v1.clipFlags & v2.clipFlags) == Clipper::CLIP_FINITE)
+			if((v0.clipFlags & v1.clipFlags & v2.clipFlags & ~Clipper::CLIP_GUARDBAND) == Clipper::CLIP_FINITE)
 			{
 				Polygon polygon(&v0.v[pos], &v1.v[pos], &v2.v[pos]);
 
-				int clipFlagsOr = v0.clipFlags | v1.clipFlags | v2.clipFlags | draw.clipFlags;
+				int clipFlagsOr = Clipper::clipFlagsOr(v0.clipFlags | v1.clipFlags | v2.clipFlags, draw);
 
 				if(clipFlagsOr != Clipper::CLIP_FINITE)
 				{
-					if(!clipper->clip(polygon, clipFlagsOr, draw))
+					if(!draw.clipPointer(&polygon, clipFlagsOr, draw.data))
 					{
 						continue;
 					}
 				}
 
-				if(setupRoutine(primitive, triangle, &polygon, data))
+				if(setupPrimitive(unit, primitive, triangle, &polygon, draw))
 				{
 					primitive += ms;
 					visible++;
@@ -1603,7 +2040,7 @@ namespace sw
 
 		for(int i = 0; i < 3; i++)
 		{
-			if(setupLine(*primitive, *triangle, draw))
+			if(setupLine(unit, *primitive, *triangle, draw))
 			{
 				primitive->area = 0.5f * d;
 
@@ -1647,7 +2084,7 @@ namespace sw
 
 		for(int i = 0; i < 3; i++)
 		{
-			if(setupPoint(*primitive, *triangle, draw))
+			if(setupPoint(unit, *primitive, *triangle, draw))
 			{
 				primitive->area = 0.5f * d;
 
@@ -1674,7 +2111,7 @@ namespace sw
 
 		for(int i = 0; i < count; i++)
 		{
-			if(setupLine(*primitive, *triangle, draw))
+			if(setupLine(unit, *primitive, *triangle, draw))
 			{
 				primitive += ms;
 				visible++;
@@ -1699,7 +2136,7 @@ namespace sw
 
 		for(int i = 0; i < count; i++)
 		{
-			if(setupPoint(*primitive, *triangle, draw))
+			if(setupPoint(unit, *primitive, *triangle, draw))
 			{
 				primitive += ms;
 				visible++;
@@ -1711,9 +2148,8 @@ namespace sw
 		return visible;
 	}
 
-	bool Renderer::setupLine(Primitive &primitive, Triangle &triangle, const DrawCall &draw)
+	bool Renderer::setupLine(int unit, Primitive &primitive, Triangle &triangle, const DrawCall &draw)
 	{
-		const SetupProcessor::RoutinePointer &setupRoutine = draw.setupPointer;
 		const SetupProcessor::State &state = draw.setupState;
 		const DrawData &data = *draw.data;
 
@@ -1788,13 +2224,13 @@ namespace sw
 
 				if(clipFlagsOr != Clipper::CLIP_FINITE)
 				{
-					if(!clipper->clip(polygon, clipFlagsOr, draw))
+					if(!draw.clipPointer(&polygon, clipFlagsOr, draw.data))
 					{
 						return false;
 					}
 				}
 
-				return setupRoutine(&primitive, &triangle, &polygon, &data);
+				return setupPrimitive(unit, &primitive, &triangle, &polygon, draw);
 			}
 		}
 		else   // Diamond test convention
@@ -1894,22 +2330,21 @@ namespace sw
 
 				if(clipFlagsOr != Clipper::CLIP_FINITE)
 				{
-					if(!clipper->clip(polygon, clipFlagsOr, draw))
+					if(!draw.clipPointer(&polygon, clipFlagsOr, draw.data))
 					{
 						return false;
 					}
 				}
 
-				return setupRoutine(&primitive, &triangle, &polygon, &data);
+				return setupPrimitive(unit, &primitive, &triangle, &polygon, draw);
 			}
 		}
 
 		return false;
 	}
 
-	bool Renderer::setupPoint(Primitive &primitive, Triangle &triangle, const DrawCall &draw)
+	bool Renderer::setupPoint(int unit, Primitive &primitive, Triangle &triangle, const DrawCall &draw)
 	{
-		const SetupProcessor::RoutinePointer &setupRoutine = draw.setupPointer;
 		const SetupProcessor::State &state = draw.setupState;
 		const DrawData &data = *draw.data;
 
@@ -1973,13 +2408,13 @@ namespace sw
 
 			if(clipFlagsOr != Clipper::CLIP_FINITE)
 			{
-				if(!clipper->clip(polygon, clipFlagsOr, draw))
+				if(!draw.clipPointer(&polygon, clipFlagsOr, draw.data))
 				{
 					return false;
 				}
 			}
 
-			return setupRoutine(&primitive, &triangle, &polygon, &data);
+			return setupPrimitive(unit, &primitive, &triangle, &polygon, draw);
 		}
 
 		return false;
@@ -1992,29 +2427,24 @@ namespace sw
 
 		for(int i = 0; i < unitCount; i++)
 		{
-			triangleBatch[i] = (Triangle*)allocate(batchSize * sizeof(Triangle));
-			primitiveBatch[i] = (Primitive*)allocate(batchSize * sizeof(Primitive));
+			triangleBatch[i] = (Triangle*)allocate(maxBatchSize * sizeof(Triangle));
+			primitiveBatch[i] = (Primitive*)allocate(maxBatchSize * sizeof(Primitive));
+			outlineBuffer[i] = new OutlineBuffer();
 		}
 
+		threadPool = ThreadPool::acquire(threadCount, (ThreadPool::Affinity)threadAffinity, threadAffinityCPUs);
+
+		// Each thread index is a slot which runs as a pool job while it's awake
 		for(int i = 0; i < threadCount; i++)
 		{
 			vertexTask[i] = (VertexTask*)allocate(sizeof(VertexTask));
-			vertexTask[i]->vertexCache.drawCall = -1;
+			vertexTask[i]->vertexCache.initialize(vertexCacheSize, vertexCacheAssociativity);
+			vertexTask[i]->positionCache.initialize(vertexCacheSize, vertexCacheAssociativity);
 
 			task[i].type = Task::SUSPEND;
 
-			resume[i] = new Event();
+			slotActive[i] = false;
 			suspend[i] = new Event();
-
-			Parameters parameters;
-			parameters.threadIndex = i;
-			parameters.renderer = this;
-
-			exitThreads = false;
-			worker[i] = new Thread(threadFunction, &parameters);
-
-			suspend[i]->wait();
-			suspend[i]->signal();
 		}
 	}
 
@@ -2027,20 +2457,29 @@ namespace sw
 
 		for(int thread = 0; thread < threadCount; thread++)
 		{
-			if(worker[thread])
+			if(suspend[thread])
 			{
-				exitThreads = true;
-				resume[thread]->signal();
-				worker[thread]->join();
+				schedulerMutex.lock();
+
+				while(slotActive[thread])   // Wait for the slot's last pool job to return
+				{
+					schedulerMutex.unlock();
+					suspend[thread]->wait();
+					schedulerMutex.lock();
+				}
+
+				schedulerMutex.unlock();
 
-				delete worker[thread];
-				worker[thread] = 0;
-				delete resume[thread];
-				resume[thread] = 0;
 				delete suspend[thread];
 				suspend[thread] = 0;
 			}
 
+			if(vertexTask[thread])
+			{
+				vertexTask[thread]->vertexCache.release();
+				vertexTask[thread]->positionCache.release();
+			}
+
 			deallocate(vertexTask[thread]);
 			vertexTask[thread] = 0;
 		}
@@ -2052,6 +2491,15 @@ namespace sw
 
 			deallocate(primitiveBatch[i]);
 			primitiveBatch[i] = 0;
+
+			delete outlineBuffer[i];
+			outlineBuffer[i] = 0;
+		}
+
+		if(threadPool)
+		{
+			threadPool->release();
+			threadPool = nullptr;
 		}
 	}
 
@@ -2158,6 +2606,29 @@ namespace sw
 		sw::transparencyAntialiasing = transparencyAntialiasing;
 	}
 
+	bool Renderer::setupPrimitive(int unit, Primitive *primitive, Triangle *triangle, Polygon *polygon, const DrawCall &draw)
+	{
+		const DrawData *data = draw.data;
+		int ms = draw.setupState.multiSample;
+
+		// Enough rows for every sample to cover the scissor rectangle plus the padding spans
+		int height = (data->scissorY1 - data->scissorY0 + 5) & ~1;
+		Primitive::Span *storage = outlineBuffer[unit]->reserve(ms * height);
+
+		primitive->outline = storage;
+
+		if(!draw.setupPointer(primitive, triangle, polygon, data))
+		{
+			return false;
+		}
+
+		// Setup rebased the outline to row 0, so the first row in use is found by the distance to the storage
+		int yLow = (int)(storage - primitive->outline);
+		outlineBuffer[unit]->commit(ms * ((primitive->yMax + 3 - yLow) & ~1));
+
+		return true;
+	}
+
 	bool Renderer::isReadWriteTexture(int sampler)
 	{
 		for(int index = 0; index < RENDERTARGETS; index++)
@@ -2176,6 +2647,23 @@ namespace sw
 		return false;
 	}
 
+	// Replaces the state and hashes it, unless compare is set and it's unchanged. Returns whether it was replaced.
+	template<class ProcessorState>
+	bool Renderer::updateState(ProcessorState &state, const ProcessorState &newState, bool compare)
+	{
+		typedef typename ProcessorState::States States;   // Excludes the hash
+
+		if(compare && memcmp(static_cast<const States*>(&state), static_cast<const States*>(&newState), sizeof(States)) == 0)
+		{
+			return false;
+		}
+
+		state = newState;
+		state.hash = state.computeHash();
+
+		return true;
+	}
+
 	void Renderer::updateClipper()
 	{
 		if(updateClipPlanes)
@@ -2505,18 +2993,26 @@ namespace sw
 
 	void Renderer::setPixelShaderConstantF(unsigned int index, const float value[4], unsigned int count)
 	{
-		for(unsigned int i = 0; i < DRAW_COUNT; i++)
+		// Only the registers which actually change need to be copied into the draw calls
+		unsigned int dirtyBlocks = 0;
+
+		for(unsigned int i = 0; i < count; i++)
 		{
-			if(drawCall[i]->psDirtyConstF < index + count)
+			if(index + i < FRAGMENT_UNIFORM_VECTORS && memcmp(&PixelProcessor::c[index + i], value, sizeof(float4)) != 0)
 			{
-				drawCall[i]->psDirtyConstF = index + count;
+				PixelProcessor::setFloatConstant(index + i, value);
+				dirtyBlocks |= 1 << ((index + i) >> constantBlockShift);
 			}
+
+			value += 4;
 		}
 
-		for(unsigned int i = 0; i < count; i++)
+		if(dirtyBlocks)
 		{
-			PixelProcessor::setFloatConstant(index + i, value);
-			value += 4;
+			for(unsigned int i = 0; i < DRAW_COUNT; i++)
+			{
+				drawCall[i]->psDirtyConstF |= dirtyBlocks;
+			}
 		}
 	}
 
@@ -2556,18 +3052,26 @@ namespace sw
 
 	void Renderer::setVertexShaderConstantF(unsigned int index, const float value[4], unsigned int count)
 	{
-		for(unsigned int i = 0; i < DRAW_COUNT; i++)
+		// Only the registers which actually change need to be copied into the draw calls
+		unsigned int dirtyBlocks = 0;
+
+		for(unsigned int i = 0; i < count; i++)
 		{
-			if(drawCall[i]->vsDirtyConstF < index + count)
+			if(index + i < VERTEX_UNIFORM_VECTORS && memcmp(&VertexProcessor::c[index + i], value, sizeof(float4)) != 0)
 			{
-				drawCall[i]->vsDirtyConstF = index + count;
+				VertexProcessor::setFloatConstant(index + i, value);
+				dirtyBlocks |= 1 << ((index + i) >> constantBlockShift);
 			}
+
+			value += 4;
 		}
 
-		for(unsigned int i = 0; i < count; i++)
+		if(dirtyBlocks)
 		{
-			VertexProcessor::setFloatConstant(index + i, value);
-			value += 4;
+			for(unsigned int i = 0; i < DRAW_COUNT; i++)
+			{
+				drawCall[i]->vsDirtyConstF |= dirtyBlocks;
+			}
 		}
 	}
 
@@ -2702,14 +3206,24 @@ namespace sw
 
 		if(newConfiguration || initialUpdate)
 		{
+			if(routineCompiler)
+			{
+				routineCompiler->finish();   // Pending draws need their routines before the threads can finish
+			}
+
 			terminateThreads();
 
 			SwiftConfig::Configuration configuration = {};
 			swiftConfig->getConfiguration(configuration);
 
-			precacheVertex = !newConfiguration && configuration.precache;
-			precacheSetup = !newConfiguration && configuration.precache;
-			precachePixel = !newConfiguration && configuration.precache;
+			bool precache = !newConfiguration && configuration.precache && !configuration.precacheDirectory.empty() && objectCodeSupported;
+
+			precacheVertex = precache;
+			precacheSetup = precache;
+			precachePixel = precache;
+			precacheDirectory = configuration.precacheDirectory;
+
+			routineStatesValid = false;   // The routine caches get recreated
 
 			VertexProcessor::setRoutineCacheSize(configuration.vertexRoutineCacheSize);
 			PixelProcessor::setRoutineCacheSize(configuration.pixelRoutineCacheSize);
@@ -2786,6 +3300,24 @@ namespace sw
 			default: threadCount = configuration.threadCount; break;
 			}
 
+			threadAffinity = clamp(configuration.threadAffinity, (int)ThreadPool::AFFINITY_NONE, (int)ThreadPool::AFFINITY_LAST);
+			threadAffinityCPUs = configuration.threadAffinityCPUs;
+
+			delete routineCompiler;
+			routineCompiler = nullptr;
+
+			tierUpThreshold = configuration.tierUpThreshold;
+			vertexCacheSize = configuration.vertexCacheSize;
+			vertexCacheAssociativity = configuration.vertexCacheAssociativity;
+			positionOnlyCulling = configuration.positionOnlyCulling;
+			guardBandClipping = configuration.guardBandClipping;
+
+			if(configuration.asyncRoutineCompilation)
+			{
+				int compilerThreads = min(max(CPUID::coreCount() / 2, 1), 4);
+				routineCompiler = new RoutineCompiler(compilerThreads, routineCompiled, this);
+			}
+
 			CPUID::setEnableSSE4_1(configuration.enableSSE4_1);
 			CPUID::setEnableSSSE3(configuration.enableSSSE3);
 			CPUID::setEnableSSE3(configuration.enableSSE3);
@@ -2802,6 +3334,7 @@ namespace sw
 			postBlendSRGB = configuration.postBlendSRGB;
 			exactColorRounding = configuration.exactColorRounding;
 			forceClearRegisters = configuration.forceClearRegisters;
+			tileRasterization = configuration.tileRasterization;
 
 		#ifndef NDEBUG
 			minPrimitives = configuration.minPrimitives;
@@ -2809,7 +3342,7 @@ namespace sw
 		#endif
 		}
 
-		if(!initialUpdate && !worker[0])
+		if(!initialUpdate && !threadPool)
 		{
 			initializeThreads();
 		}
@@ -20,15 +20,20 @@
 #include "SetupProcessor.hpp"
 #include "Plane.hpp"
 #include "Blitter.hpp"
+#include "OutlineBuffer.hpp"
 #include "Common/MutexLock.hpp"
 #include "Common/Thread.hpp"
+#include "Common/WorkStealingQueue.hpp"
 #include "Main/Config.hpp"
 
 #include <list>
+#include <string>
 
 namespace sw
 {
 	class Clipper;
+	class RoutineCompiler;
+	class ThreadPool;
 	class PixelShader;
 	class VertexShader;
 	class SwiftConfig;
@@ -111,12 +116,24 @@ namespace sw
 		const Type type;
 	};
 
+	struct DeferredClear
+	{
+		void set(Surface *surface);
+
+		unsigned char *tiles;   // Non-zero for tiles still to be filled
+		int pitch;              // In tiles
+		unsigned int value;     // Replicated to 32-bit
+		int width;              // Rounded up to pairs of pixels
+		int height;
+	};
+
 	struct DrawData
 	{
 		const Constants *constants;
 
 		const void *input[MAX_VERTEX_INPUTS];
 		unsigned int stride[MAX_VERTEX_INPUTS];
+		unsigned int divisor[MAX_VERTEX_INPUTS];
 		Texture mipmap[TOTAL_IMAGE_UNITS];
 		const void *indices;
 
@@ -150,8 +167,6 @@ namespace sw
 
 		PS ps;
 
-		int instanceID;
-
 		VertexProcessor::PointSprite point;
 		float lineWidth;
 
@@ -159,10 +174,13 @@ namespace sw
 		PixelProcessor::Stencil stencilCCW;
 		PixelProcessor::Fog fog;
 		PixelProcessor::Factor factor;
+		PixelProcessor::Blend blend;
 		unsigned int occlusion[16];   // Number of pixels passing depth test
 
 		#if PERF_PROFILE
 			int64_t cycles[PERF_TIMERS][16];
+			int64_t vertexCacheHits[16];     // Per unit
+			int64_t vertexCacheMisses[16];
 		#endif
 
 		TextureStage::Uniforms textureStage[8];
@@ -175,6 +193,7 @@ namespace sw
 		float4 YYYY;
 		float4 halfPixelX;
 		float4 halfPixelY;
+		float4 guardBand;   // Half-extent of the guard band, in normalized device coordinates
 		float viewportHeight;
 		float slopeDepthBias;
 		float depthRange;
@@ -187,6 +206,12 @@ namespace sw
 		float *depthBuffer;
 		int depthPitchB;
 		int depthSliceB;
+		float *hiZBuffer;   // Maximum depth of each tile
+		int hiZPitch;
+		int depthWidth;
+		int depthHeight;
+		DeferredClear colorClear[RENDERTARGETS];
+		DeferredClear depthClear;
 		unsigned char *stencilBuffer;
 		int stencilPitchB;
 		int stencilSliceB;
@@ -212,11 +237,17 @@ namespace sw
 		AtomicInt batchSize;
 
 		Routine *vertexRoutine;
+		Routine *positionRoutine;   // Null unless triangles get culled before computing all vertex outputs
 		Routine *setupRoutine;
+		Routine *clipRoutine;
 		Routine *pixelRoutine;
+		Routine *pixelFallback;   // Null unless the pixel routine was still being compiled when the draw was issued
 
+		// Null while the routine is being compiled in the background
 		VertexProcessor::RoutinePointer vertexPointer;
+		VertexProcessor::RoutinePointer positionPointer;
 		SetupProcessor::RoutinePointer setupPointer;
+		SetupProcessor::ClipPointer clipPointer;
 		PixelProcessor::RoutinePointer pixelPointer;
 
 		int (Renderer::*setupPrimitives)(int batch, int count);
@@ -232,7 +263,7 @@ namespace sw
 		Resource* vUniformBuffers[MAX_UNIFORM_BUFFER_BINDINGS];
 		Resource* transformFeedbackBuffers[MAX_TRANSFORM_FEEDBACK_INTERLEAVED_COMPONENTS];
 
-		unsigned int vsDirtyConstF;
+		unsigned int vsDirtyConstF;   // Mask of the blocks of float constants changed since they were last copied
 		unsigned int vsDirtyConstI;
 		unsigned int vsDirtyConstB;
 
@@ -243,9 +274,11 @@ namespace sw
 		std::list<Query*> *queries;
 
 		AtomicInt clipFlags;
+		bool guardBand;   // Triangles within the guard band don't get clipped against the sides
 
 		AtomicInt primitive;    // Current primitive to enter pipeline
-		AtomicInt count;        // Number of primitives to render
+		AtomicInt count;        // Number of primitives to render, for all instances
+		int instancePrimitives; // Number of primitives per instance
 		AtomicInt references;   // Remaining references to this draw call, 0 when done drawing, -1 when resources unlocked and slot is free
 
 		DrawData *data;
@@ -319,7 +352,7 @@ namespace sw
 		void *operator new(size_t size);
 		void operator delete(void * mem);
 
-		void draw(DrawType drawType, unsigned int indexOffset, unsigned int count, bool update = true);
+		void draw(DrawType drawType, unsigned int indexOffset, unsigned int count, unsigned int instanceCount = 1, bool update = true);
 
 		void clear(void *value, Format format, Surface *dest, const Rect &rect, unsigned int rgbaMask);
 		void blit(Surface *source, const SliceRectF &sRect, Surface *dest, const SliceRect &dRect, bool filter, bool isStencil = false, bool sRGBconversion = true);
@@ -404,15 +437,23 @@ namespace sw
 		static int getClusterCount() { return clusterCount; }
 
 	private:
-		static void threadFunction(void *parameters);
-		void threadLoop(int threadIndex);
+		static bool runTasks(void *parameters, int threadIndex);
+		bool runTasks(int threadIndex);
 		void taskLoop(int threadIndex);
-		void findAvailableTasks();
+		void findAvailableTasks(int threadIndex);
+		bool routinesReady(DrawCall *draw);
+		int primitiveBatchSize(uint64_t count) const;
+		bool takeTask(int threadIndex);
 		void scheduleTask(int threadIndex);
 		void executeTask(int threadIndex);
 		void finishRendering(Task &pixelTask);
+		void resumeThreads();
+		void resumeSlot(int threadIndex);
+		bool suspendSlot(int threadIndex);
+		static void routineCompiled(void *parameters);
 
-		void processPrimitiveVertices(int unit, unsigned int start, unsigned int count, unsigned int loop, int thread);
+		int processPrimitiveVertices(int unit, unsigned int start, unsigned int count, unsigned int loop, int thread);
+		unsigned int cullTriangles(int unit, unsigned int (*batch)[3], unsigned int count, int thread);
 
 		int setupSolidTriangles(int batch, int count);
 		int setupWireframeTriangle(int batch, int count);
@@ -420,10 +461,13 @@ namespace sw
 		int setupLines(int batch, int count);
 		int setupPoints(int batch, int count);
 
-		bool setupLine(Primitive &primitive, Triangle &triangle, const DrawCall &draw);
-		bool setupPoint(Primitive &primitive, Triangle &triangle, const DrawCall &draw);
+		bool setupLine(int unit, Primitive &primitive, Triangle &triangle, const DrawCall &draw);
+		bool setupPoint(int unit, Primitive &primitive, Triangle &triangle, const DrawCall &draw);
+		bool setupPrimitive(int unit, Primitive *primitive, Triangle *triangle, Polygon *polygon, const DrawCall &draw);
 
 		bool isReadWriteTexture(int sampler);
+		template<class ProcessorState>
+		static bool updateState(ProcessorState &state, const ProcessorState &newState, bool compare);
 		void updateClipper();
 		void updateConfiguration(bool initialUpdate = false);
 		void initializeThreads();
@@ -435,23 +479,27 @@ namespace sw
 		Context *context;
 		Clipper *clipper;
 		Blitter *blitter;
+		RoutineCompiler *routineCompiler;   // Null when routines are compiled on the application thread
 		Viewport viewport;
 		Rect scissor;
 		int clipFlags;
 
 		Triangle *triangleBatch[16];
 		Primitive *primitiveBatch[16];
+		OutlineBuffer *outlineBuffer[16];
 
 		// User-defined clipping planes
 		Plane userPlane[MAX_CLIP_PLANES];
 		Plane clipPlane[MAX_CLIP_PLANES];   // Tranformed to clip space
 		bool updateClipPlanes;
 
-		AtomicInt exitThreads;
+		ThreadPool *threadPool;    // Shared by all Renderers
+		int threadCount;           // Task slots, each runs as a pool job while awake
+		int threadAffinity;        // ThreadPool::Affinity policy for pinning the pool threads
+		std::string threadAffinityCPUs;   // Explicit CPU list, overrides the policy when not empty
 		AtomicInt threadsAwake;
-		Thread *worker[16];
-		Event *resume[16];         // Events for resuming threads
-		Event *suspend[16];        // Events for suspending threads
+		bool slotActive[16];       // A pool job is queued or running for the slot, guarded by schedulerMutex
+		Event *suspend[16];        // Signaled when a slot's pool job returns
 		Event *resumeApp;          // Event for resuming the application thread
 
 		PrimitiveProgress primitiveProgress[16];
@@ -469,16 +517,19 @@ namespace sw
 		AtomicInt nextDraw;
 
 		enum {
-			TASK_COUNT = 32,   // Size of the task queue (must be power of 2)
-			TASK_COUNT_BITS = TASK_COUNT - 1,
+			TASK_COUNT = 32,     // Size of each thread's task queue (must be power of 2)
+			TASK_QUANTUM = 64,   // Tasks a slot executes before yielding its pool thread to other queued jobs
+			SCHEDULER_SPINS = 16,   // Attempts to take a published task before blocking on the scheduler lock
 		};
-		Task taskQueue[TASK_COUNT];
-		AtomicInt qHead;
-		AtomicInt qSize;
+		WorkStealingQueue<Task, TASK_COUNT> taskQueue[16];   // Tasks published by each thread, can be taken by any thread
+		AtomicInt qSize;   // Total number of queued tasks
 
-		static AtomicInt unitCount;
-		static AtomicInt clusterCount;
+		int unitCount;
+		static AtomicInt clusterCount;   // Compiled into the pixel routines, so shared by all Renderers
 
+		// Only guards task discovery. Tasks are published to and taken from the per-thread
+		// queues without it, but finding them must see consistent primitive and pixel
+		// progress to render primitives in order, so only one thread searches at a time.
 		MutexLock schedulerMutex;
 
 		#if PERF_HUD
@@ -499,8 +550,14 @@ namespace sw
 		PixelProcessor::State pixelState;
 
 		Routine *vertexRoutine;
+		Routine *positionRoutine;
 		Routine *setupRoutine;
+		Routine *clipRoutine;
 		Routine *pixelRoutine;
+		Routine *pixelFallback;
+
+		bool routineStatesValid;   // The routines above match the states above
+		int routineClipFlags;
 	};
 }
 
@@ -0,0 +1,345 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "RoutineArchive.hpp"
+
+#include "Context.hpp"
+#include "Renderer.hpp"
+#include "Primitive.hpp"
+#include "Reactor/Nucleus.hpp"
+#include "Reactor/Routine.hpp"
+#include "Common/CPUID.hpp"
+#include "Common/Math.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+	#include <Windows.h>
+#else
+	#include <unistd.h>
+#endif
+
+namespace sw
+{
+	std::string precacheDirectory;   // Archives are only used when set
+
+	extern bool halfIntegerCoordinates;
+	extern bool symmetricNormalizedDepth;
+	extern bool booleanFaceRegister;
+	extern bool fullPixelPositionRegister;
+	extern bool leadingVertexFirst;
+	extern bool secondaryColor;
+	extern bool colorsDefaultToZero;
+	extern bool quadLayoutEnabled;
+	extern bool veryEarlyDepthTest;
+	extern bool complementaryDepthBuffer;
+	extern bool postBlendSRGB;
+	extern bool exactColorRounding;
+	extern TransparencyAntialiasing transparencyAntialiasing;
+	extern bool forceClearRegisters;
+	extern bool tileRasterization;
+
+	static const char magic[4] = {'S', 'W', 'R', 'C'};
+	static const uint32_t version = 2;
+	static const uint32_t codeVersion = 1;   // Increment with every change to the generated code
+	static const size_t maxFileSize = 64 * 1024 * 1024;   // Stop growing the archive beyond this
+
+	RoutineArchive::RoutineArchive(const char *name, size_t keySize) : fileName(precacheDirectory + "/" + name + ".cache"), keySize(keySize)
+	{
+		opened = false;
+		modified = false;
+	}
+
+	RoutineArchive::~RoutineArchive()
+	{
+		storePending();
+
+		for(auto &entry : pending)
+		{
+			entry.routine->unbind();   // Never compiled, not stored
+		}
+
+		if(modified)
+		{
+			save();
+		}
+	}
+
+	Routine *RoutineArchive::load(const void *key, uint64_t hash)
+	{
+		size_t objectSize = 0;
+		const void *object = find(key, hash, objectSize);
+
+		return object ? Nucleus::loadRoutine(object, objectSize) : nullptr;
+	}
+
+	const void *RoutineArchive::find(const void *key, uint64_t hash, size_t &objectSize)
+	{
+		if(!opened)
+		{
+			open();
+		}
+
+		objectSize = 0;
+		auto range = index.equal_range(hash);
+
+		for(auto i = range.first; i != range.second; ++i)
+		{
+			Record record;
+			memcpy(&record, &contents[i->second], sizeof(Record));   // Records aren't aligned
+
+			const uint8_t *recordKey = &contents[i->second + sizeof(Record)];
+			const uint8_t *object = recordKey + keySize;
+
+			if(memcmp(recordKey, key, keySize) != 0)
+			{
+				continue;
+			}
+
+			if(record.checksum != checksum(recordKey, object, record.objectSize))
+			{
+				index.erase(i);   // Corrupt, don't check it again
+				return nullptr;
+			}
+
+			objectSize = record.objectSize;
+
+			return object;
+		}
+
+		return nullptr;
+	}
+
+	void RoutineArchive::store(const void *key, uint64_t hash, Routine *routine)
+	{
+		if(!opened)
+		{
+			open();
+		}
+
+		storePending();
+
+		size_t objectSize = 0;
+		const void *object = routine->getObject(objectSize);
+
+		if(!object)   // Still being compiled in the background
+		{
+			const uint8_t *keyBytes = static_cast<const uint8_t*>(key);
+
+			routine->bind();
+			pending.push_back({std::vector<uint8_t>(keyBytes, keyBytes + keySize), hash, routine});
+
+			return;
+		}
+
+		append(key, hash, object, objectSize);
+	}
+
+	void RoutineArchive::storePending()
+	{
+		for(size_t i = 0; i < pending.size(); )
+		{
+			size_t objectSize = 0;
+			const void *object = pending[i].routine->getObject(objectSize);
+
+			if(!object)
+			{
+				i++;
+				continue;
+			}
+
+			append(pending[i].key.data(), pending[i].hash, object, objectSize);
+
+			pending[i].routine->unbind();
+			pending[i] = pending.back();
+			pending.pop_back();
+		}
+	}
+
+	void RoutineArchive::append(const void *key, uint64_t hash, const void *object, size_t objectSize)
+	{
+		if(sizeof(Header) + contents.size() + sizeof(Record) + keySize + objectSize > maxFileSize)
+		{
+			return;
+		}
+
+		Record record = {};
+		record.hash = hash;
+		record.checksum = checksum(key, object, objectSize);
+		record.objectSize = (uint32_t)objectSize;
+
+		size_t offset = contents.size();
+		contents.resize(offset + sizeof(Record) + keySize + objectSize);
+		memcpy(&contents[offset], &record, sizeof(Record));
+		memcpy(&contents[offset + sizeof(Record)], key, keySize);
+		memcpy(&contents[offset + sizeof(Record) + keySize], object, objectSize);
+
+		index.insert(std::make_pair(hash, offset));
+		modified = true;
+	}
+
+	void RoutineArchive::open()
+	{
+		opened = true;
+
+		std::vector<uint8_t> data;
+
+		if(FILE *file = fopen(fileName.c_str(), "rb"))
+		{
+			uint8_t buffer[0x10000];
+			size_t n;
+
+			while((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+			{
+				data.insert(data.end(), buffer, buffer + n);
+			}
+
+			fclose(file);
+		}
+
+		parse(data);
+	}
+
+	void RoutineArchive::save()
+	{
+		// Other processes only ever see a complete archive, either the old one or this one
+		#if defined(_WIN32)
+			unsigned long processID = GetCurrentProcessId();
+		#else
+			unsigned long processID = getpid();
+		#endif
+
+		std::string tempName = fileName + "." + std::to_string(processID) + ".tmp";
+		FILE *file = fopen(tempName.c_str(), "wb");
+
+		if(!file)
+		{
+			return;
+		}
+
+		Header header = currentHeader();
+
+		bool written = fwrite(&header, sizeof(Header), 1, file) == 1 &&
+		               (contents.empty() || fwrite(contents.data(), contents.size(), 1, file) == 1);
+		written = (fclose(file) == 0) && written;
+
+		#if defined(_WIN32)
+			written = written && MoveFileExA(tempName.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+		#else
+			written = written && rename(tempName.c_str(), fileName.c_str()) == 0;
+		#endif
+
+		if(!written)
+		{
+			remove(tempName.c_str());
+		}
+	}
+
+	void RoutineArchive::parse(const std::vector<uint8_t> &data)
+	{
+		Header header = currentHeader();
+
+		if(data.size() < sizeof(Header) || memcmp(data.data(), &header, sizeof(Header)) != 0)
+		{
+			return;   // Stale, replaced on save
+		}
+
+		size_t offset = sizeof(Header);
+
+		while(data.size() - offset >= sizeof(Record) + keySize)
+		{
+			Record record;
+			memcpy(&record, &data[offset], sizeof(Record));
+
+			size_t recordSize = sizeof(Record) + keySize + record.objectSize;
+
+			if(record.objectSize == 0 || recordSize > data.size() - offset)
+			{
+				break;
+			}
+
+			offset += recordSize;
+		}
+
+		contents.assign(data.begin() + sizeof(Header), data.begin() + offset);
+
+		for(size_t i = 0; i < contents.size(); )
+		{
+			Record record;
+			memcpy(&record, &contents[i], sizeof(Record));
+			index.insert(std::make_pair(record.hash, i));
+
+			i += sizeof(Record) + keySize + record.objectSize;
+		}
+	}
+
+	RoutineArchive::Header RoutineArchive::currentHeader() const
+	{
+		Header header = {};
+		memcpy(header.magic, magic, sizeof(magic));
+		header.version = version;
+		header.fingerprint = fingerprint();
+		header.keySize = (uint32_t)keySize;
+
+		return header;
+	}
+
+	uint64_t RoutineArchive::fingerprint()
+	{
+		// Identifies the generated code, the layout of the data it accesses, and all the global settings which affect it
+		std::vector<uint64_t> data;
+
+		data.push_back(codeVersion);
+		data.push_back(sizeof(void*));
+
+		data.push_back(sizeof(VertexProcessor::State));
+		data.push_back(sizeof(SetupProcessor::State));
+		data.push_back(sizeof(PixelProcessor::State));
+		data.push_back(sizeof(DrawData));
+		data.push_back(sizeof(Primitive));
+		data.push_back(sizeof(Triangle));
+		data.push_back(sizeof(Vertex));
+		data.push_back(sizeof(VertexTask));
+		data.push_back(sizeof(Texture));
+		data.push_back(sizeof(Mipmap));
+
+		data.push_back(CPUID::supportsMMX2() | CPUID::supportsCMOV() << 1 | CPUID::supportsSSE() << 2 | CPUID::supportsSSE2() << 3 |
+		               CPUID::supportsSSE3() << 4 | CPUID::supportsSSSE3() << 5 | CPUID::supportsSSE4_1() << 6);
+
+		data.push_back(halfIntegerCoordinates | symmetricNormalizedDepth << 1 | booleanFaceRegister << 2 | fullPixelPositionRegister << 3 |
+		               leadingVertexFirst << 4 | secondaryColor << 5 | colorsDefaultToZero << 6 | quadLayoutEnabled << 7 |
+		               veryEarlyDepthTest << 8 | complementaryDepthBuffer << 9 | postBlendSRGB << 10 | exactColorRounding << 11 |
+		               forceClearRegisters << 12 | tileRasterization << 13 | perspectiveCorrection << 14);
+
+		data.push_back(transparencyAntialiasing);
+		data.push_back(logPrecision | expPrecision << 8 | rcpPrecision << 16 | rsqPrecision << 24);
+		data.push_back(Renderer::getClusterCount());
+
+		for(int pass = 0; pass < 10; pass++)
+		{
+			data.push_back(optimization[pass]);
+		}
+
+		return FNV_1a(reinterpret_cast<const unsigned char*>(data.data()), (int)(data.size() * sizeof(uint64_t)));
+	}
+
+	uint64_t RoutineArchive::checksum(const void *key, const void *object, size_t objectSize) const
+	{
+		uint64_t keyHash = FNV_1a(reinterpret_cast<const unsigned char*>(key), (int)keySize);
+		uint64_t objectHash = FNV_1a(reinterpret_cast<const unsigned char*>(object), (int)objectSize);
+
+		return keyHash * 31 + objectHash;
+	}
+}
@@ -0,0 +1,96 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef sw_RoutineArchive_hpp
+#define sw_RoutineArchive_hpp
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sw
+{
+	class Routine;
+
+	extern std::string precacheDirectory;
+
+	// Persistent storage of routine object code in '<name>.cache' within the
+	// precache directory, indexed by processor state keys. New routines are
+	// collected in memory and written out when the archive is destroyed, through
+	// a temporary file which replaces the archive in one step. The file is
+	// discarded when the code generation version, the data layout or the
+	// settings don't match the ones it was written with. Routines which are
+	// still being compiled are held on to, and stored once their object code
+	// is available. Only used when the Reactor backend supports object code.
+	class RoutineArchive
+	{
+	public:
+		RoutineArchive(const char *name, size_t keySize);
+
+		~RoutineArchive();
+
+		Routine *load(const void *key, uint64_t hash);
+		void store(const void *key, uint64_t hash, Routine *routine);
+
+		// Returns the object code stored for the key, or null. Valid until the next store().
+		const void *find(const void *key, uint64_t hash, size_t &objectSize);
+
+	private:
+		struct Header
+		{
+			char magic[4];
+			uint32_t version;
+			uint64_t fingerprint;
+			uint32_t keySize;
+			uint32_t reserved;
+		};
+
+		struct Record   // Followed by the key and the object code
+		{
+			uint64_t hash;
+			uint64_t checksum;
+			uint32_t objectSize;
+			uint32_t reserved;
+		};
+
+		struct Pending
+		{
+			std::vector<uint8_t> key;
+			uint64_t hash;
+			Routine *routine;
+		};
+
+		void storePending();
+		void append(const void *key, uint64_t hash, const void *object, size_t objectSize);
+		void open();
+		void save();
+		void parse(const std::vector<uint8_t> &data);
+		Header currentHeader() const;
+		static uint64_t fingerprint();
+		uint64_t checksum(const void *key, const void *object, size_t objectSize) const;
+
+		const std::string fileName;
+		const size_t keySize;
+
+		bool opened;   // Opened on first use, once the configuration is final
+		bool modified;
+
+		std::vector<uint8_t> contents;                      // Records read at startup and stored since
+		std::unordered_multimap<uint64_t, size_t> index;    // Record offsets by key hash
+		std::vector<Pending> pending;                       // Stored once compiled
+	};
+}
+
+#endif   // sw_RoutineArchive_hpp
@@ -16,11 +16,15 @@
 #define sw_RoutineCache_hpp
 
 #include "LRUCache.hpp"
+#include "RoutineArchive.hpp"
 
 #include "Reactor/Reactor.hpp"
 
 namespace sw
 {
+	// Routine cache which, when given a precache name, also keeps the routines
+	// in a persistent archive so they don't need to be compiled again by the
+	// next process.
 	template<class State>
 	class RoutineCache : public LRUCache<State, Routine>
 	{
@@ -28,21 +32,52 @@ namespace sw
 		RoutineCache(int n, const char *precache = 0);
 		~RoutineCache();
 
+		Routine *query(const State &state);
+		Routine *add(const State &state, Routine *routine);
+
 	private:
-		const char *precache;
-		#if defined(_WIN32)
-		HMODULE precacheDLL;
-		#endif
+		RoutineArchive *archive;
 	};
 
 	template<class State>
-	RoutineCache<State>::RoutineCache(int n, const char *precache) : LRUCache<State, Routine>(n), precache(precache)
+	RoutineCache<State>::RoutineCache(int n, const char *precache) : LRUCache<State, Routine>(n)
 	{
+		archive = precache ? new RoutineArchive(precache, sizeof(State)) : nullptr;
 	}
 
 	template<class State>
 	RoutineCache<State>::~RoutineCache()
 	{
+		delete archive;
+	}
+
+	template<class State>
+	Routine *RoutineCache<State>::query(const State &state)
+	{
+		Routine *routine = LRUCache<State, Routine>::query(state);
+
+		if(!routine && archive)
+		{
+			routine = archive->load(&state, state.hash);
+
+			if(routine)
+			{
+				LRUCache<State, Routine>::add(state, routine);
+			}
+		}
+
+		return routine;
+	}
+
+	template<class State>
+	Routine *RoutineCache<State>::add(const State &state, Routine *routine)
+	{
+		if(archive)
+		{
+			archive->store(&state, state.hash, routine);   // Before getEntry() relocates the object code
+		}
+
+		return LRUCache<State, Routine>::add(state, routine);
 	}
 }
 
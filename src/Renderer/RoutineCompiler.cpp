@@ -0,0 +1,258 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "RoutineCompiler.hpp"
+
+#include "Reactor/Nucleus.hpp"
+#include "Common/Debug.hpp"
+
+namespace sw
+{
+	int tierUpThreshold = 16;   // Draw calls using a routine before it gets recompiled with full optimization, 0 to disable
+
+	DeferredRoutine::DeferredRoutine(bool keepObject) : routine(nullptr), entry(nullptr), keepObject(keepObject)
+	{
+	}
+
+	DeferredRoutine::~DeferredRoutine()
+	{
+		if(routine)
+		{
+			routine->unbind();
+		}
+	}
+
+	const void *DeferredRoutine::getEntry()
+	{
+		return entry.load(std::memory_order_acquire);
+	}
+
+	const void *DeferredRoutine::getObject(size_t &size)
+	{
+		size = getEntry() ? object.size() : 0;   // Written before the entry is published
+
+		return size ? object.data() : nullptr;
+	}
+
+	void DeferredRoutine::resolve(Routine *routine)
+	{
+		ASSERT(!this->routine);
+
+		routine->bind();
+		this->routine = routine;
+
+		if(keepObject)
+		{
+			size_t size = 0;
+			const uint8_t *code = static_cast<const uint8_t*>(routine->getObject(size));
+
+			if(code)
+			{
+				object.assign(code, code + size);
+			}
+		}
+
+		// Relocate the code on this thread, so readers only see a finished routine
+		entry.store(routine->getEntry(), std::memory_order_release);
+	}
+
+	TieredRoutine::TieredRoutine(Routine *baseline, const std::function<Routine*()> &optimize, int threshold, RoutineCompiler *compiler)
+		: baseline(baseline), optimized(nullptr), optimize(optimize), compiler(compiler), threshold(threshold), uses(0)
+	{
+		ASSERT(compiler);
+	}
+
+	TieredRoutine::~TieredRoutine()
+	{
+		baseline->unbind();
+
+		if(Routine *routine = optimized.load())
+		{
+			routine->unbind();
+		}
+	}
+
+	const void *TieredRoutine::getEntry()
+	{
+		Routine *routine = optimized.load(std::memory_order_acquire);
+
+		if(routine)
+		{
+			if(const void *entry = routine->getEntry())
+			{
+				return entry;
+			}
+		}
+
+		const void *entry = baseline->getEntry();
+
+		if(entry && !routine && uses.fetch_add(1) + 1 == threshold)
+		{
+			tierUp();   // Only reached once
+		}
+
+		return entry;
+	}
+
+	const void *TieredRoutine::getObject(size_t &size)
+	{
+		Routine *routine = optimized.load(std::memory_order_acquire);
+
+		if(routine)
+		{
+			if(const void *object = routine->getObject(size))
+			{
+				return object;
+			}
+		}
+
+		return baseline->getObject(size);
+	}
+
+	void TieredRoutine::tierUp()
+	{
+		Routine *routine = compiler->compile(optimize);
+
+		optimize = nullptr;   // Releases the captured state
+		optimized.store(routine, std::memory_order_release);
+	}
+
+	RoutineCompiler::RoutineCompiler(int threadCount, void (*compiled)(void *parameters), void *parameters)
+		: compiled(compiled), parameters(parameters), pending(0), exit(false)
+	{
+		for(int i = 0; i < threadCount; i++)
+		{
+			threads.push_back(new Thread(threadFunction, this));
+		}
+	}
+
+	RoutineCompiler::~RoutineCompiler()
+	{
+		finish();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			exit = true;
+		}
+
+		jobAvailable.notify_all();
+
+		for(auto thread : threads)
+		{
+			thread->join();
+			delete thread;
+		}
+	}
+
+	Routine *RoutineCompiler::compile(const std::function<Routine*()> &generate, bool keepObject)
+	{
+		DeferredRoutine *routine = new DeferredRoutine(keepObject);
+		routine->bind();   // Released by the caller
+		routine->bind();   // Released once compiled
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs.push_back({routine, generate});
+			pending++;
+		}
+
+		jobAvailable.notify_one();
+
+		return routine;
+	}
+
+	void RoutineCompiler::finish()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		jobsFinished.wait(lock, [this]() { return pending == 0; });
+	}
+
+	void RoutineCompiler::threadFunction(void *parameters)
+	{
+		static_cast<RoutineCompiler*>(parameters)->threadLoop();
+	}
+
+	void RoutineCompiler::threadLoop()
+	{
+		while(true)
+		{
+			Job job;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				jobAvailable.wait(lock, [this]() { return exit || !jobs.empty(); });
+
+				if(jobs.empty())
+				{
+					return;
+				}
+
+				job = jobs.front();
+				jobs.pop_front();
+			}
+
+			job.routine->resolve(job.generate());
+			job.routine->unbind();
+
+			compiled(parameters);
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				pending--;
+			}
+
+			jobsFinished.notify_all();
+		}
+	}
+
+	Routine *compileRoutine(RoutineCompiler *compiler, const std::function<Routine*()> &generate, bool archived)
+	{
+		// Tiering up on the application thread would stall it, and is pointless without a faster baseline
+		bool tiered = !archived && compiler && tierUpThreshold > 0 && minimalOptimizationSupported;
+
+		std::function<Routine*()> baseline = generate;
+
+		if(tiered)
+		{
+			baseline = [generate]()
+			{
+				optimizeRoutines = false;
+				Routine *routine = generate();
+				optimizeRoutines = true;
+
+				return routine;
+			};
+		}
+
+		Routine *routine = nullptr;
+
+		if(compiler)
+		{
+			routine = compiler->compile(baseline, archived);
+		}
+		else
+		{
+			routine = baseline();
+			routine->bind();
+		}
+
+		if(tiered)
+		{
+			routine = new TieredRoutine(routine, generate, tierUpThreshold, compiler);
+			routine->bind();
+		}
+
+		return routine;
+	}
+}
@@ -0,0 +1,129 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef sw_RoutineCompiler_hpp
+#define sw_RoutineCompiler_hpp
+
+#include "Reactor/Routine.hpp"
+#include "Common/Thread.hpp"
+
+#include <atomic>
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace sw
+{
+	class RoutineCompiler;
+
+	// Stand-in for a routine which is being compiled in the background. Its
+	// entry is null until the actual routine is available. When 'keepObject'
+	// is set, the routine's object code is copied before it gets relocated, so
+	// it remains available to the routine archive.
+	class DeferredRoutine : public Routine
+	{
+	public:
+		explicit DeferredRoutine(bool keepObject);
+
+		~DeferredRoutine() override;
+
+		const void *getEntry() override;
+		const void *getObject(size_t &size) override;
+
+		void resolve(Routine *routine);
+
+	private:
+		Routine *routine;
+		std::atomic<const void*> entry;
+		const bool keepObject;
+		std::vector<uint8_t> object;
+	};
+
+	// Routine which is first compiled with minimal optimization, and recompiled with full
+	// optimization once 'threshold' draw calls have used it. Each non-null getEntry() result
+	// counts as a use. The optimized routine is compiled in the background by 'compiler'.
+	// Entries handed out before the switch remain valid for its lifetime.
+	class TieredRoutine : public Routine
+	{
+	public:
+		// Takes over the caller's reference to 'baseline'
+		TieredRoutine(Routine *baseline, const std::function<Routine*()> &optimize, int threshold, RoutineCompiler *compiler);
+
+		~TieredRoutine() override;
+
+		const void *getEntry() override;
+		const void *getObject(size_t &size) override;   // Of the optimized routine once available
+
+	private:
+		void tierUp();
+
+		Routine *const baseline;
+		std::atomic<Routine*> optimized;
+		std::function<Routine*()> optimize;   // Released once used
+		RoutineCompiler *const compiler;
+		const int threshold;
+		std::atomic<int> uses;
+	};
+
+	// Pool of threads which compile routines off the application thread
+	class RoutineCompiler
+	{
+	public:
+		// 'compiled' is called on the compiler thread each time a routine becomes available
+		RoutineCompiler(int threadCount, void (*compiled)(void *parameters), void *parameters);
+
+		~RoutineCompiler();
+
+		// Returns a DeferredRoutine which resolves to the routine produced by 'generate'.
+		// It holds a reference for the caller, so it can't be released by the compiler
+		// thread before the caller binds it. Call unbind() to release it.
+		Routine *compile(const std::function<Routine*()> &generate, bool keepObject = false);
+
+		void finish();   // Waits for all queued routines to be compiled
+
+	private:
+		static void threadFunction(void *parameters);
+		void threadLoop();
+
+		struct Job
+		{
+			DeferredRoutine *routine;
+			std::function<Routine*()> generate;
+		};
+
+		void (*const compiled)(void *parameters);
+		void *const parameters;
+
+		std::vector<Thread*> threads;
+
+		std::mutex mutex;
+		std::condition_variable jobAvailable;
+		std::condition_variable jobsFinished;
+		std::deque<Job> jobs;
+		int pending;   // Queued or being compiled
+		bool exit;
+	};
+
+	// Returns the routine produced by 'generate', with a reference held for the caller. It's
+	// compiled in the background when given a compiler. With a compiler it's first compiled
+	// with minimal optimization when tierUpThreshold is non-zero and the Reactor backend
+	// supports it (only LLVM does), unless the routine gets 'archived'. Archived routines keep their object
+	// code available, and are always fully optimized.
+	Routine *compileRoutine(RoutineCompiler *compiler, const std::function<Routine*()> &generate, bool archived);
+}
+
+#endif   // sw_RoutineCompiler_hpp
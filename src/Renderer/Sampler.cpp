@@ -46,9 +46,12 @@ namespace sw
 			for(int face = 0; face < 6; face++)
 			{
 				mipmap.buffer[face] = &zero;
+				deferredClearSurface[level][face] = nullptr;
 			}
 		}
 
+		deferredClearSurfaces = 0;
+
 		externalTextureFormat = FORMAT_NULL;
 		internalTextureFormat = FORMAT_NULL;
 		textureType = TEXTURE_NULL;
@@ -114,6 +117,10 @@ namespace sw
 
 	void Sampler::setTextureLevel(int face, int level, Surface *surface, TextureType type)
 	{
+		Surface *deferredClear = (surface && surface->supportsDeferredClear()) ? surface : nullptr;
+		deferredClearSurfaces += (deferredClear != nullptr) - (deferredClearSurface[level][face] != nullptr);
+		deferredClearSurface[level][face] = deferredClear;
+
 		if(surface)
 		{
 			Mipmap &mipmap = texture.mipmap[level];
@@ -253,6 +260,51 @@ namespace sw
 		textureType = type;
 	}
 
+	bool Sampler::hasDeferredClears() const
+	{
+		if(deferredClearSurfaces == 0)
+		{
+			return false;
+		}
+
+		// Faces of a previously bound cube map may remain, but aren't sampled
+		int faces = (textureType == TEXTURE_CUBE) ? 6 : 1;
+
+		for(int level = 0; level < MIPMAP_LEVELS; level++)
+		{
+			for(int face = 0; face < faces; face++)
+			{
+				if(deferredClearSurface[level][face] && deferredClearSurface[level][face]->hasDeferredClear())
+				{
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	void Sampler::resolveDeferredClears()
+	{
+		if(deferredClearSurfaces == 0)
+		{
+			return;
+		}
+
+		int faces = (textureType == TEXTURE_CUBE) ? 6 : 1;
+
+		for(int level = 0; level < MIPMAP_LEVELS; level++)
+		{
+			for(int face = 0; face < faces; face++)
+			{
+				if(deferredClearSurface[level][face])
+				{
+					deferredClearSurface[level][face]->resolveDeferredClear();
+				}
+			}
+		}
+	}
+
 	void Sampler::setTextureFilter(FilterType textureFilter)
 	{
 		this->textureFilter = (FilterType)min(textureFilter, maximumTextureFilterQuality);
@@ -173,6 +173,8 @@ namespace sw
 		State samplerState() const;
 
 		void setTextureLevel(int face, int level, Surface *surface, TextureType type);
+		bool hasDeferredClears() const;   // Some bound surface has cleared tiles still to be filled
+		void resolveDeferredClears();     // Fills them, before drawing with them
 
 		void setTextureFilter(FilterType textureFilter);
 		void setMipmapFilter(MipmapType mipmapFilter);
@@ -237,6 +239,9 @@ namespace sw
 		Texture texture;
 		float exp2LOD;
 
+		Surface *deferredClearSurface[MIPMAP_LEVELS][6];   // Bound surfaces which support deferred clears
+		int deferredClearSurfaces;
+
 		static FilterType maximumTextureFilterQuality;
 		static MipmapType maximumMipmapFilterQuality;
 	};
@@ -16,8 +16,11 @@
 
 #include "Primitive.hpp"
 #include "Polygon.hpp"
+#include "Clipper.hpp"
 #include "Context.hpp"
 #include "Renderer.hpp"
+#include "RoutineCompiler.hpp"
+#include "Shader/ClipRoutine.hpp"
 #include "Shader/SetupRoutine.hpp"
 #include "Shader/Constants.hpp"
 #include "Common/Debug.hpp"
@@ -29,17 +32,9 @@ namespace sw
 
 	bool precacheSetup = false;
 
-	unsigned int SetupProcessor::States::computeHash()
+	uint64_t SetupProcessor::States::computeHash()
 	{
-		unsigned int *state = (unsigned int*)this;
-		unsigned int hash = 0;
-
-		for(unsigned int i = 0; i < sizeof(States) / 4; i++)
-		{
-			hash ^= state[i];
-		}
-
-		return hash;
+		return FNV_1a(reinterpret_cast<const unsigned char*>(this), sizeof(States));
 	}
 
 	SetupProcessor::State::State(int i)
@@ -57,16 +52,31 @@ namespace sw
 		return memcmp(static_cast<const States*>(this), static_cast<const States*>(&state), sizeof(States)) == 0;
 	}
 
+	SetupProcessor::ClipState::ClipState(int clipFlags) : clipFlags(clipFlags & Clipper::CLIP_USER)
+	{
+		hash = FNV_1a(reinterpret_cast<const unsigned char*>(&this->clipFlags), sizeof(this->clipFlags));
+	}
+
+	bool SetupProcessor::ClipState::operator==(const ClipState &state) const
+	{
+		return clipFlags == state.clipFlags;
+	}
+
 	SetupProcessor::SetupProcessor(Context *context) : context(context)
 	{
 		routineCache = 0;
 		setRoutineCacheSize(1024);
+
+		clipRoutineCache = new RoutineCache<ClipState>(64);   // One per combination of user clip planes
 	}
 
 	SetupProcessor::~SetupProcessor()
 	{
 		delete routineCache;
 		routineCache = 0;
+
+		delete clipRoutineCache;
+		clipRoutineCache = 0;
 	}
 
 	SetupProcessor::State SetupProcessor::update() const
@@ -218,28 +228,57 @@ namespace sw
 			state.fog.flat = point;
 		}
 
-		state.hash = state.computeHash();
-
 		return state;
 	}
 
-	Routine *SetupProcessor::routine(const State &state)
+	Routine *SetupProcessor::routine(const State &state, RoutineCompiler *compiler)
 	{
 		Routine *routine = routineCache->query(state);
 
 		if(!routine)
 		{
-			SetupRoutine *generator = new SetupRoutine(state);
-			generator->generate();
-			routine = generator->getRoutine();
-			delete generator;
-
+			routine = compileRoutine(compiler, [state]() { return generate(state); }, precacheSetup);
 			routineCache->add(state, routine);
+			routine->unbind();
 		}
 
 		return routine;
 	}
 
+	Routine *SetupProcessor::clipRoutine(const ClipState &state, RoutineCompiler *compiler)
+	{
+		Routine *routine = clipRoutineCache->query(state);
+
+		if(!routine)
+		{
+			routine = compileRoutine(compiler, [state]() { return generate(state); }, false);
+			clipRoutineCache->add(state, routine);
+			routine->unbind();
+		}
+
+		return routine;
+	}
+
+	Routine *SetupProcessor::generate(const State &state)
+	{
+		SetupRoutine *generator = new SetupRoutine(state);
+		generator->generate();
+		Routine *routine = generator->getRoutine();
+		delete generator;
+
+		return routine;
+	}
+
+	Routine *SetupProcessor::generate(const ClipState &state)
+	{
+		ClipRoutine *generator = new ClipRoutine(state);
+		generator->generate();
+		Routine *routine = generator->getRoutine();
+		delete generator;
+
+		return routine;
+	}
+
 	void SetupProcessor::setRoutineCacheSize(int cacheSize)
 	{
 		delete routineCache;
@@ -29,13 +29,14 @@ namespace sw
 	struct Vertex;
 	struct DrawCall;
 	struct DrawData;
+	class RoutineCompiler;
 
 	class SetupProcessor
 	{
 	public:
 		struct States
 		{
-			unsigned int computeHash();
+			uint64_t computeHash();
 
 			bool isDrawPoint               : 1;
 			bool isDrawLine                : 1;
@@ -80,25 +81,41 @@ namespace sw
 
 			bool operator==(const State &states) const;
 
-			unsigned int hash;
+			uint64_t hash;
+		};
+
+		struct ClipState
+		{
+			ClipState(int clipFlags = 0);
+
+			bool operator==(const ClipState &state) const;
+
+			int clipFlags;   // User clip planes
+			uint64_t hash;
 		};
 
 		typedef bool (*RoutinePointer)(Primitive *primitive, const Triangle *triangle, const Polygon *polygon, const DrawData *draw);
+		typedef bool (*ClipPointer)(Polygon *polygon, int clipFlagsOr, const DrawData *draw);
 
 		SetupProcessor(Context *context);
 
 		~SetupProcessor();
 
 	protected:
-		State update() const;
-		Routine *routine(const State &state);
+		State update() const;   // Leaves the hash to the caller, see Renderer::updateState()
+		Routine *routine(const State &state, RoutineCompiler *compiler = nullptr);   // Compiles in the background when given a compiler, see compileRoutine()
+		Routine *clipRoutine(const ClipState &state, RoutineCompiler *compiler = nullptr);
 
 		void setRoutineCacheSize(int cacheSize);
 
 	private:
+		static Routine *generate(const State &state);
+		static Routine *generate(const ClipState &state);
+
 		Context *const context;
 
 		RoutineCache<State> *routineCache;
+		RoutineCache<ClipState> *clipRoutineCache;
 	};
 }
 
@@ -47,6 +47,7 @@ namespace sw
 		Resource *resource;
 		const void *buffer;
 		unsigned int stride;
+		unsigned int divisor;   // Advance once every 'divisor' instances instead of every vertex, when non-zero
 	};
 
 	struct Stream : public StreamResource
@@ -56,6 +57,7 @@ namespace sw
 			this->resource = resource;
 			this->buffer = buffer;
 			this->stride = stride;
+			this->divisor = 0;
 		}
 
 		Stream &define(StreamType type, unsigned int count, bool normalized = false)
@@ -84,6 +86,7 @@ namespace sw
 			resource = 0;
 			buffer = &null;
 			stride = 0;
+			divisor = 0;
 			type = STREAMTYPE_FLOAT;
 			count = 0;
 			normalized = false;
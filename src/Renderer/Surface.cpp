@@ -30,6 +30,8 @@
 	#include <emmintrin.h>
 #endif
 
+#include <limits>
+
 #undef min
 #undef max
 
@@ -37,6 +39,7 @@ namespace sw
 {
 	extern bool quadLayoutEnabled;
 	extern bool complementaryDepthBuffer;
+	extern bool tileRasterization;
 	extern TranscendentalPrecision logPrecision;
 
 	unsigned int *Surface::palette = 0;
@@ -1293,6 +1296,11 @@ namespace sw
 
 		dirtyContents = true;
 		paletteUsed = 0;
+
+		hiZ = nullptr;
+		clearTiles = nullptr;
+		clearValue = 0;
+		clearPending = false;
 	}
 
 	Surface::Surface(Resource *texture, int width, int height, int depth, int border, int samples, Format format, bool lockable, bool renderTarget, int pitchPprovided) : lockable(lockable), renderTarget(renderTarget)
@@ -1350,6 +1358,11 @@ namespace sw
 
 		dirtyContents = true;
 		paletteUsed = 0;
+
+		hiZ = nullptr;
+		clearTiles = nullptr;
+		clearValue = 0;
+		clearPending = false;
 	}
 
 	Surface::~Surface()
@@ -1374,16 +1387,25 @@ namespace sw
 		}
 
 		deallocate(stencil.buffer);
+		deallocate(hiZ);
+		deallocate(clearTiles);
 
 		external.buffer = 0;
 		internal.buffer = 0;
 		stencil.buffer = 0;
+		hiZ = nullptr;
+		clearTiles = nullptr;
 	}
 
 	void *Surface::lockExternal(int x, int y, int z, Lock lock, Accessor client)
 	{
 		resource->lock(client);
 
+		if(clearPending)
+		{
+			applyDeferredClear();
+		}
+
 		if(!external.buffer)
 		{
 			if(internal.buffer && identicalFormats())
@@ -1414,6 +1436,7 @@ namespace sw
 		case LOCK_READWRITE:
 		case LOCK_DISCARD:
 			dirtyContents = true;
+			invalidateHiZ();
 			break;
 		default:
 			ASSERT(false);
@@ -1448,6 +1471,19 @@ namespace sw
 			}
 		}
 
+		if(clearPending)
+		{
+			if(lock == LOCK_DISCARD)
+			{
+				memset(clearTiles, 0, getTileCount());
+				clearPending = false;
+			}
+			else if(lock != LOCK_UNLOCKED && (client != MANAGED || !tileRasterization))   // Otherwise the pixel routines fill tiles as they draw
+			{
+				applyDeferredClear();
+			}
+		}
+
 		// FIXME: WHQL requires conversion to lower external precision and back
 		if(logPrecision >= WHQL)
 		{
@@ -1493,6 +1529,11 @@ namespace sw
 		case LOCK_READWRITE:
 		case LOCK_DISCARD:
 			dirtyContents = true;
+
+			if(client == PUBLIC)   // The renderer keeps the hierarchical Z up to date itself
+			{
+				invalidateHiZ();
+			}
 			break;
 		default:
 			ASSERT(false);
@@ -3267,7 +3308,7 @@ namespace sw
 		// FIXME: Unpacking byte4 to short4 in the sampler currently involves reading 8 bytes,
 		// and stencil operations also read 8 bytes per four 8-bit stencil values,
 		// so we have to allocate 4 extra bytes to avoid buffer overruns.
-		return allocate(size(width2, height2, depth, border, samples, format) + 4);
+		return allocateInterleaved(size(width2, height2, depth, border, samples, format) + 4);   // Rendered by all threads
 	}
 
 	void Surface::memfill4(void *buffer, int pattern, int bytes)
@@ -3384,6 +3425,19 @@ namespace sw
 		int x1 = x0 + width;
 		int y1 = y0 + height;
 
+		if(entire && supportsDeferredClear())
+		{
+			if(hasQuadLayout(internal.format) && complementaryDepthBuffer)
+			{
+				depth = 1 - depth;
+			}
+
+			deferClear((unsigned int&)depth);
+			clearHiZ(depth, x0, y0, x1, y1);
+
+			return;
+		}
+
 		if(!hasQuadLayout(internal.format))
 		{
 			float *target = (float*)lockInternal(x0, y0, 0, lock, PUBLIC);
@@ -3483,6 +3537,8 @@ namespace sw
 
 			unlockInternal();
 		}
+
+		clearHiZ(depth, x0, y0, x1, y1);
 	}
 
 	void Surface::clearStencil(unsigned char s, unsigned char mask, int x0, int y0, int width, int height)
@@ -3744,6 +3800,135 @@ namespace sw
 		return isDepth(external.format);
 	}
 
+	bool Surface::hasHiZ() const
+	{
+		return hasDepth() && internal.samples == 1 && internal.depth == 1;
+	}
+
+	float *Surface::getHiZ()
+	{
+		if(!hiZ && hasHiZ())
+		{
+			hiZ = (float*)allocate(getTileCount() * sizeof(float));
+			invalidateHiZ();
+		}
+
+		return hiZ;
+	}
+
+	void Surface::invalidateHiZ()
+	{
+		if(hiZ)
+		{
+			for(int i = 0; i < getTileCount(); i++)
+			{
+				hiZ[i] = std::numeric_limits<float>::infinity();
+			}
+		}
+	}
+
+	void Surface::clearHiZ(float depth, int x0, int y0, int x1, int y1)
+	{
+		if(!hiZ)
+		{
+			return;
+		}
+
+		// Tiles only partially cleared were invalidated when locking
+		for(int ty = y0 >> TILE_SHIFT; ty << TILE_SHIFT < y1; ty++)
+		{
+			if(ty << TILE_SHIFT < y0 || min((ty + 1) << TILE_SHIFT, internal.height) > y1)
+			{
+				continue;
+			}
+
+			for(int tx = x0 >> TILE_SHIFT; tx << TILE_SHIFT < x1; tx++)
+			{
+				if(tx << TILE_SHIFT >= x0 && min((tx + 1) << TILE_SHIFT, internal.width) <= x1)
+				{
+					hiZ[ty * getTilePitch() + tx] = depth;
+				}
+			}
+		}
+	}
+
+	bool Surface::supportsDeferredClear() const
+	{
+		// Render targets and depth buffers have even dimensions, so tiles can be filled in pairs of pixels
+		return (renderTarget || hasDepth()) && internal.samples == 1 && internal.depth == 1 && internal.border == 0 &&
+		       (internal.bytes == 2 || internal.bytes == 4);
+	}
+
+	void Surface::deferClear(unsigned int value)
+	{
+		ASSERT(supportsDeferredClear());
+
+		lockInternal(0, 0, 0, LOCK_DISCARD, PUBLIC);
+
+		if(!clearTiles)
+		{
+			clearTiles = (unsigned char*)allocate(getTileCount());
+		}
+
+		memset(clearTiles, 1, getTileCount());
+		clearValue = (internal.bytes == 2) ? (value & 0xFFFF) * 0x00010001 : value;
+		clearPending = true;
+
+		unlockInternal();
+	}
+
+	void Surface::resolveDeferredClear()
+	{
+		if(clearPending)
+		{
+			applyDeferredClear();
+		}
+	}
+
+	unsigned char *Surface::getClearTiles()
+	{
+		if(!clearTiles && supportsDeferredClear())
+		{
+			clearTiles = (unsigned char*)allocate(getTileCount());
+			memset(clearTiles, 0, getTileCount());
+		}
+
+		return clearTiles;
+	}
+
+	void Surface::applyDeferredClear()
+	{
+		// Quad layout buffers store pairs of rows together, but all pixels have the same value
+		int rowStep = hasQuadLayout(internal.format) ? 2 : 1;
+		int width = align(internal.width, 2);
+		int height = align(internal.height, 2);
+
+		for(int ty = 0; ty << TILE_SHIFT < height; ty++)
+		{
+			for(int tx = 0; tx << TILE_SHIFT < width; tx++)
+			{
+				unsigned char &tile = clearTiles[ty * getTilePitch() + tx];
+
+				if(tile)
+				{
+					int x0 = tx << TILE_SHIFT;
+					int x1 = min(x0 + TILE_SIZE, width);
+					int y0 = ty << TILE_SHIFT;
+					int y1 = min(y0 + TILE_SIZE, height);
+
+					for(int y = y0; y < y1; y += rowStep)
+					{
+						memfill4((unsigned char*)internal.buffer + y * internal.pitchB + x0 * internal.bytes * rowStep, clearValue, (x1 - x0) * internal.bytes * rowStep);
+					}
+
+					tile = 0;
+				}
+			}
+		}
+
+		clearPending = false;
+	}
+
 	bool Surface::hasPalette() const
 	{
 		return isPalette(external.format);
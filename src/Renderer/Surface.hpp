@@ -327,6 +327,27 @@ namespace sw
 		inline int getMultiSampleCount() const;
 		inline int getSuperSampleCount() const;
 
+		inline int getTilePitch() const;   // TILE_SIZE x TILE_SIZE screen tiles per row
+
+		// Hierarchical Z: the maximum depth of each tile, or infinity when unknown. Only
+		// available for single-sampled, single-layer depth buffers, otherwise getHiZ() returns null.
+		// Draws only test against it with tile rasterization, a less(-equal) depth compare and no
+		// stencil test. Writes which bypass the rasterizer invalidate the tiles they touch.
+		bool hasHiZ() const;
+		float *getHiZ();   // Allocated on first use
+		void invalidateHiZ();
+
+		// Deferred clears: clearing all of a single-sampled render target or depth buffer only records
+		// the value. With tile rasterization the renderer fills each tile when it first gets drawn to,
+		// any other access fills all the remaining ones when locking. Samplers don't lock, draws which
+		// sample the surface fill them with resolveDeferredClear().
+		bool supportsDeferredClear() const;
+		void deferClear(unsigned int value);   // Value of a pixel in the internal format
+		void resolveDeferredClear();           // The caller's lock on the resource must exclude draws to it
+		inline bool hasDeferredClear() const;
+		unsigned char *getClearTiles();        // Non-zero for tiles still to be filled, allocated on first use
+		inline unsigned int getClearValue() const;   // Replicated to 32-bit
+
 		bool isEntire(const Rect& rect) const;
 		Rect getRect() const;
 		void clearDepth(float depth, int x0, int y0, int width, int height);
@@ -488,6 +509,10 @@ namespace sw
 		bool identicalFormats() const;
 		Format selectInternalFormat(Format format) const;
 
+		inline int getTileCount() const;
+		void clearHiZ(float depth, int x0, int y0, int x1, int y1);
+		void applyDeferredClear();
+
 		void resolve();
 
 		Buffer external;
@@ -505,6 +530,12 @@ namespace sw
 
 		bool hasParent;
 		bool ownExternal;
+
+		float *hiZ;
+
+		unsigned char *clearTiles;
+		unsigned int clearValue;
+		bool clearPending;
 	};
 }
 
@@ -648,6 +679,26 @@ namespace sw
 		return internal.samples > 4 ? internal.samples / 4 : 1;
 	}
 
+	int Surface::getTilePitch() const
+	{
+		return (internal.width + TILE_SIZE - 1) >> TILE_SHIFT;
+	}
+
+	int Surface::getTileCount() const
+	{
+		return getTilePitch() * ((internal.height + TILE_SIZE - 1) >> TILE_SHIFT);
+	}
+
+	bool Surface::hasDeferredClear() const
+	{
+		return clearPending;
+	}
+
+	unsigned int Surface::getClearValue() const
+	{
+		return clearValue;
+	}
+
 	bool Surface::isUnlocked() const
 	{
 		return external.lock == LOCK_UNLOCKED &&
@@ -0,0 +1,283 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ThreadPool.hpp"
+
+#include "Common/CPUID.hpp"
+#include "Common/Math.hpp"
+#include "Common/Memory.hpp"
+#include "Common/Debug.hpp"
+
+#include <algorithm>
+#include <stdlib.h>
+
+namespace sw
+{
+	std::mutex ThreadPool::poolMutex;
+	ThreadPool *ThreadPool::pool = nullptr;
+
+	ThreadPool *ThreadPool::acquire(int threadCount, Affinity affinity, const std::string &cpuList)
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+
+		if(!pool)
+		{
+			pool = new ThreadPool();
+		}
+
+		pool->references++;
+		threadCount = clamp(threadCount, 1, (int)MAX_THREADS);
+		pool->setPlacement(threadCount, affinity, cpuList);
+		pool->setThreadCount(threadCount);
+
+		return pool;
+	}
+
+	void ThreadPool::release()
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+
+		ASSERT(pool == this);
+
+		if(--references == 0)
+		{
+			delete pool;
+			pool = nullptr;
+		}
+	}
+
+	ThreadPool::ThreadPool() : references(0), threadCount(0), placementSerial(0)
+	{
+		for(int i = 0; i < MAX_THREADS; i++)
+		{
+			worker[i].pool = this;
+			worker[i].threadIndex = i;
+			worker[i].thread = nullptr;
+			worker[i].placementSerial = 0;
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		ASSERT(jobs.empty());
+
+		setThreadCount(0);
+	}
+
+	void ThreadPool::submit(Function function, void *parameters, int index)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs.push_back({function, parameters, index});
+		}
+
+		jobAvailable.notify_one();
+	}
+
+	void ThreadPool::setThreadCount(int count)
+	{
+		int oldCount = 0;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			oldCount = threadCount;
+			threadCount = count;
+		}
+
+		jobAvailable.notify_all();
+
+		// Jobs return after a bounded amount of work, so surplus threads exit promptly
+		for(int i = count; i < oldCount; i++)
+		{
+			worker[i].thread->join();
+			delete worker[i].thread;
+			worker[i].thread = nullptr;
+		}
+
+		for(int i = oldCount; i < count; i++)
+		{
+			worker[i].thread = new Thread(threadFunction, &worker[i]);
+		}
+	}
+
+	void ThreadPool::setPlacement(int count, Affinity affinity, const std::string &cpuList)
+	{
+		std::vector<int> cpus = parseCPUList(cpuList);
+
+		if(cpus.empty() && affinity != AFFINITY_NONE)
+		{
+			// Group the CPUs by NUMA node, keeping their order within each node
+			std::vector<std::vector<int>> nodes;
+
+			for(int cpu : CPUID::affinityCPUs())
+			{
+				size_t node = CPUID::numaNode(cpu);
+
+				if(node >= nodes.size())
+				{
+					nodes.resize(node + 1);
+				}
+
+				nodes[node].push_back(cpu);
+			}
+
+			for(size_t i = 0; cpus.size() < MAX_THREADS; i++)
+			{
+				bool added = false;
+
+				for(auto &node : nodes)
+				{
+					if(affinity == AFFINITY_COMPACT)
+					{
+						cpus.insert(cpus.end(), node.begin(), node.end());
+					}
+					else if(i < node.size())
+					{
+						cpus.push_back(node[i]);
+						added = true;
+					}
+				}
+
+				if(!added)
+				{
+					break;
+				}
+			}
+		}
+
+		// Spread large allocations over the nodes the rendering threads run on,
+		// instead of putting them all on the node of the thread which creates them
+		uint64_t nodeMask = 0;
+
+		for(int i = 0; i < count && !cpus.empty(); i++)
+		{
+			nodeMask |= (uint64_t)1 << (CPUID::numaNode(cpus[i % cpus.size()]) & 63);
+		}
+
+		setInterleaveNodes((nodeMask & (nodeMask - 1)) ? nodeMask : 0);
+
+		// Unpinned threads may run on any of the process's CPUs
+		std::vector<int> processCPUs = cpus.empty() ? CPUID::affinityCPUs() : std::vector<int>();
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		unpinnedCPUs = processCPUs;
+
+		if(cpus != placement)   // Threads which were never pinned keep the affinity they inherited
+		{
+			placement = cpus;
+			placementSerial++;
+		}
+	}
+
+	std::vector<int> ThreadPool::threadCPUs(int threadIndex) const
+	{
+		if(placement.empty())
+		{
+			return unpinnedCPUs;
+		}
+
+		return {placement[threadIndex % placement.size()]};
+	}
+
+	std::vector<int> ThreadPool::parseCPUList(const std::string &cpuList)
+	{
+		std::vector<int> cpus;
+		const char *string = cpuList.c_str();
+
+		while(*string)
+		{
+			char *end = nullptr;
+			long first = strtol(string, &end, 10);
+
+			if(end == string)   // Skip separators and anything unexpected
+			{
+				string++;
+				continue;
+			}
+
+			long last = first;
+			string = end;
+
+			if(*string == '-')
+			{
+				last = strtol(string + 1, &end, 10);
+				string = (end == string + 1) ? string + 1 : end;
+			}
+
+			for(long cpu = first; cpu <= last && cpu >= 0 && cpus.size() < MAX_THREADS; cpu++)
+			{
+				cpus.push_back((int)cpu);
+			}
+		}
+
+		return cpus;
+	}
+
+	void ThreadPool::threadFunction(void *parameters)
+	{
+		Worker *worker = static_cast<Worker*>(parameters);
+
+		worker->pool->threadLoop(worker->threadIndex);
+	}
+
+	void ThreadPool::threadLoop(int threadIndex)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while(true)
+		{
+			jobAvailable.wait(lock, [&]() { return threadIndex >= threadCount || !jobs.empty(); });
+
+			if(threadIndex >= threadCount)
+			{
+				break;
+			}
+
+			// Pinning is a system call, so only decide on it while holding the lock
+			bool repin = worker[threadIndex].placementSerial != placementSerial;
+			std::vector<int> cpus;
+
+			if(repin)
+			{
+				worker[threadIndex].placementSerial = placementSerial;
+				cpus = threadCPUs(threadIndex);
+			}
+
+			Job job = jobs.front();
+			jobs.pop_front();
+
+			lock.unlock();
+
+			if(repin)
+			{
+				Thread::setAffinity(cpus);
+			}
+
+			bool done = job.function(job.parameters, job.index);
+			lock.lock();
+
+			if(!done)
+			{
+				jobs.push_back(job);
+			}
+		}
+
+		// Pass on any wakeup this thread consumed
+		if(!jobs.empty())
+		{
+			jobAvailable.notify_one();
+		}
+	}
+}
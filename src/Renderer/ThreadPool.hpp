@@ -0,0 +1,106 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef sw_ThreadPool_hpp
+#define sw_ThreadPool_hpp
+
+#include "Common/Thread.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sw
+{
+	// Process-wide pool of rendering threads, shared by all Renderers. Jobs are run in
+	// submission order, and a job which returns before it's done gets queued again behind
+	// the ones submitted in the meantime, so one busy Renderer can't starve the others.
+	class ThreadPool
+	{
+	public:
+		// Returns true when done, false to be queued again
+		typedef bool (*Function)(void *parameters, int index);
+
+		enum Affinity
+		{
+			AFFINITY_NONE,      // Threads may run on any CPU
+			AFFINITY_COMPACT,   // Threads fill up one NUMA node before moving on to the next
+			AFFINITY_SCATTER,   // Threads alternate between NUMA nodes
+
+			AFFINITY_LAST = AFFINITY_SCATTER
+		};
+
+		// Returns the pool, creating it on first use. The last release() destroys it.
+		// The most recently requested thread count and placement apply to the whole
+		// process. A non-empty list of CPUs, like "0-3,8", takes precedence over the
+		// affinity policy, and thread i gets pinned to the i-th one in the list.
+		static ThreadPool *acquire(int threadCount, Affinity affinity = AFFINITY_NONE, const std::string &cpuList = "");
+		void release();
+
+		void submit(Function function, void *parameters, int index);
+
+		enum
+		{
+			MAX_THREADS = 16
+		};
+
+	private:
+		ThreadPool();
+
+		~ThreadPool();
+
+		void setThreadCount(int count);
+		void setPlacement(int count, Affinity affinity, const std::string &cpuList);
+		std::vector<int> threadCPUs(int threadIndex) const;   // Requires holding the mutex
+
+		static std::vector<int> parseCPUList(const std::string &cpuList);
+
+		static void threadFunction(void *parameters);
+		void threadLoop(int threadIndex);
+
+		struct Job
+		{
+			Function function;
+			void *parameters;
+			int index;
+		};
+
+		struct Worker
+		{
+			ThreadPool *pool;
+			int threadIndex;
+			Thread *thread;
+			int placementSerial;   // Placement the thread is pinned to
+		};
+
+		static std::mutex poolMutex;   // Guards creating, resizing and destroying the pool
+		static ThreadPool *pool;
+		int references;
+
+		Worker worker[MAX_THREADS];
+
+		std::mutex mutex;
+		std::condition_variable jobAvailable;
+		std::deque<Job> jobs;
+		int threadCount;   // Threads with a higher index exit
+
+		std::vector<int> placement;      // CPU for each thread index, cycled through; empty when not pinned
+		std::vector<int> unpinnedCPUs;   // CPUs the threads may use when not pinned
+		int placementSerial;             // Incremented when the placement changes
+	};
+}
+
+#endif   // sw_ThreadPool_hpp
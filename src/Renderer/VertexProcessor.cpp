@@ -14,39 +14,72 @@
 
 #include "VertexProcessor.hpp"
 
+#include "RoutineCompiler.hpp"
 #include "Shader/VertexPipeline.hpp"
 #include "Shader/VertexProgram.hpp"
 #include "Shader/VertexShader.hpp"
 #include "Shader/PixelShader.hpp"
 #include "Shader/Constants.hpp"
 #include "Common/Math.hpp"
+#include "Common/Memory.hpp"
 #include "Common/Debug.hpp"
 
+#include <memory>
 #include <string.h>
 
 namespace sw
 {
 	bool precacheVertex = false;
+	int vertexCacheSize = 64;
+	int vertexCacheAssociativity = 1;
+	bool positionOnlyCulling = true;   // Cull triangles using a position-only vertex routine before shading all outputs
+
+	void VertexCache::initialize(int size, int associativity)
+	{
+		int lines = 1;
+		while(lines * 2 <= size / 4 && lines < 1024) lines *= 2;
+
+		ways = 1;
+		while(ways * 2 <= (unsigned int)associativity && ways < (unsigned int)lines) ways *= 2;
+
+		int sets = lines / ways;
+		setMask = sets - 1;
+
+		vertex = (Vertex(*)[4])allocate(lines * sizeof(Vertex[4]));
+		tag = (unsigned int*)allocate(lines * sizeof(unsigned int));
+		victim = (unsigned int*)allocate(sets * sizeof(unsigned int));
+
+		misses = 0;
+		drawCall = -1;
+
+		clear();
+	}
+
+	void VertexCache::release()
+	{
+		deallocate(vertex);
+		deallocate(tag);
+		deallocate(victim);
+	}
 
 	void VertexCache::clear()
 	{
-		for(int i = 0; i < 16; i++)
+		unsigned int sets = setMask + 1;
+
+		for(unsigned int i = 0; i < sets * ways; i++)
 		{
 			tag[i] = 0x80000000;
 		}
-	}
 
-	unsigned int VertexProcessor::States::computeHash()
-	{
-		unsigned int *state = (unsigned int*)this;
-		unsigned int hash = 0;
-
-		for(unsigned int i = 0; i < sizeof(States) / 4; i++)
+		for(unsigned int i = 0; i < sets; i++)
 		{
-			hash ^= state[i];
+			victim[i] = 0;
 		}
+	}
 
-		return hash;
+	uint64_t VertexProcessor::States::computeHash()
+	{
+		return FNV_1a(reinterpret_cast<const unsigned char*>(this), sizeof(States));
 	}
 
 	VertexProcessor::State::State()
@@ -354,11 +387,6 @@ namespace sw
 		context->vertexFogMode = fogMode;
 	}
 
-	void VertexProcessor::setInstanceID(int instanceID)
-	{
-		context->instanceID = instanceID;
-	}
-
 	void VertexProcessor::setColorVertexEnable(bool colorVertexEnable)
 	{
 		context->setColorVertexEnable(colorVertexEnable);
@@ -918,7 +946,7 @@ namespace sw
 
 		if(context->vertexShader)
 		{
-			state.shaderID = context->vertexShader->getSerialID();
+			state.shaderID = context->vertexShader->getHash();
 		}
 		else
 		{
@@ -976,6 +1004,7 @@ namespace sw
 			state.input[i].type = context->input[i].type;
 			state.input[i].count = context->input[i].count;
 			state.input[i].normalized = context->input[i].normalized;
+			state.input[i].instanced = context->input[i].divisor != 0;
 			state.input[i].attribType = context->vertexShader ? context->vertexShader->getAttribType(i) : VertexShader::ATTRIBTYPE_FLOAT;
 		}
 
@@ -1075,35 +1104,77 @@ namespace sw
 			state.output[Fog].xClamp = true;
 		}
 
-		state.hash = state.computeHash();
-
 		return state;
 	}
 
-	Routine *VertexProcessor::routine(const State &state)
+	VertexProcessor::State VertexProcessor::positionOnlyState(const State &state)
 	{
-		Routine *routine = routineCache->query(state);
+		State positionState = state;
 
-		if(!routine)   // Create one
-		{
-			VertexRoutine *generator = nullptr;
+		positionState.positionOnly = true;
+		positionState.transformFeedbackQueryEnabled = false;
+		positionState.transformFeedbackEnabled = 0;
 
-			if(state.fixedFunction)
+		for(int i = 0; i < MAX_VERTEX_OUTPUTS; i++)
+		{
+			if(i != state.positionRegister)
 			{
-				generator = new VertexPipeline(state);
+				positionState.output[i].write = 0;
 			}
-			else
+		}
+
+		positionState.hash = positionState.computeHash();
+
+		return positionState;
+	}
+
+	bool VertexProcessor::hasVaryings(const State &state)
+	{
+		for(int i = 0; i < MAX_VERTEX_OUTPUTS; i++)
+		{
+			if(i != state.positionRegister && state.output[i].write)
 			{
-				generator = new VertexProgram(state, context->vertexShader);
+				return true;
 			}
+		}
 
-			generator->generate();
-			routine = (*generator)(L"VertexRoutine_%0.8X", state.shaderID);
-			delete generator;
+		return false;
+	}
+
+	Routine *VertexProcessor::routine(const State &state, RoutineCompiler *compiler)
+	{
+		Routine *routine = routineCache->query(state);
+
+		if(!routine)   // Create one
+		{
+			// Background and tiered compilation generate the routine later, after the application may have deleted the shader
+			std::shared_ptr<const VertexShader> shader(state.fixedFunction ? nullptr : context->vertexShader ? new VertexShader(*context->vertexShader) : new VertexShader());
 
+			routine = compileRoutine(compiler, [state, shader]() { return generate(state, shader.get()); }, precacheVertex);
 			routineCache->add(state, routine);
+			routine->unbind();
 		}
 
 		return routine;
 	}
+
+	Routine *VertexProcessor::generate(const State &state, const VertexShader *shader)
+	{
+		VertexRoutine *generator = nullptr;
+
+		if(state.fixedFunction)
+		{
+			generator = new VertexPipeline(state);
+		}
+		else
+		{
+			generator = new VertexProgram(state, shader);
+		}
+
+		generator->generate();
+		Routine *routine = (*generator)(L"VertexRoutine_%0.8X", (unsigned int)state.shaderID);
+		delete generator;
+
+		return routine;
+	}
 }
@@ -23,13 +23,24 @@
 namespace sw
 {
 	struct DrawData;
+	class RoutineCompiler;
 
-	struct VertexCache   // FIXME: Variable size
+	// Set-associative cache of transformed vertices. Each line holds the four vertices
+	// of an index quad (or one vertex replicated when texture sampling), and lines are
+	// replaced round-robin within their set.
+	struct VertexCache
 	{
+		void initialize(int size, int associativity);   // Size in vertices, associativity in lines
+		void release();
 		void clear();
 
-		Vertex vertex[16][4];
-		unsigned int tag[16];
+		Vertex (*vertex)[4];
+		unsigned int *tag;      // Grouped by set
+		unsigned int *victim;   // Next way to replace, per set
+		unsigned int setMask;
+		unsigned int ways;
+
+		unsigned int misses;    // Lookups of the last batch which missed
 
 		int drawCall;
 	};
@@ -38,7 +49,9 @@ namespace sw
 	{
 		unsigned int vertexCount;
 		unsigned int primitiveStart;
+		unsigned int instanceID;
 		VertexCache vertexCache;
+		VertexCache positionCache;   // Used by position-only routines
 	};
 
 	class VertexProcessor
@@ -46,7 +59,7 @@ namespace sw
 	public:
 		struct States
 		{
-			unsigned int computeHash();
+			uint64_t computeHash();
 
 			uint64_t shaderID;
 
@@ -81,6 +94,7 @@ namespace sw
 			bool preTransformed : 1;
 			bool superSampling  : 1;
 			bool multiSampling  : 1;
+			bool positionOnly   : 1;   // Only computes the position and clip flags, for culling ahead of the full routine
 
 			struct TextureState
 			{
@@ -103,6 +117,7 @@ namespace sw
 				StreamType type    : BITS(STREAMTYPE_LAST);
 				unsigned int count : 3;
 				bool normalized    : 1;
+				bool instanced     : 1;
 				unsigned int attribType : BITS(VertexShader::ATTRIBTYPE_LAST);
 			};
 
@@ -145,7 +160,7 @@ namespace sw
 
 			bool operator==(const State &state) const;
 
-			unsigned int hash;
+			uint64_t hash;
 		};
 
 		struct FixedFunction
@@ -220,8 +235,6 @@ namespace sw
 		void setLightAttenuation(unsigned int light, float constant, float linear, float quadratic);
 		void setLightRange(unsigned int light, float lightRange);
 
-		void setInstanceID(int instanceID);
-
 		void setFogEnable(bool fogEnable);
 		void setVertexFogMode(FogMode fogMode);
 		void setRangeFogEnable(bool enable);
@@ -283,8 +296,10 @@ namespace sw
 		const Matrix &getModelTransform(int i);
 		const Matrix &getViewTransform();
 
-		const State update(DrawType drawType);
-		Routine *routine(const State &state);
+		const State update(DrawType drawType);   // Leaves the hash to the caller, see Renderer::updateState()
+		static State positionOnlyState(const State &state);
+		static bool hasVaryings(const State &state);
+		Routine *routine(const State &state, RoutineCompiler *compiler = nullptr);   // Compiles in the background when given a compiler, see compileRoutine()
 
 		bool isFixedFunction();
 		void setRoutineCacheSize(int cacheSize);
@@ -298,6 +313,8 @@ namespace sw
 		FixedFunction ff;
 
 	private:
+		static Routine *generate(const State &state, const VertexShader *shader);
+
 		struct UniformBufferInfo
 		{
 			UniformBufferInfo();
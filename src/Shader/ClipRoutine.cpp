@@ -0,0 +1,188 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ClipRoutine.hpp"
+
+#include "Renderer/Clipper.hpp"
+#include "Renderer/Polygon.hpp"
+#include "Renderer/Renderer.hpp"
+#include "Reactor/Reactor.hpp"
+
+namespace sw
+{
+	extern bool symmetricNormalizedDepth;
+
+	ClipRoutine::ClipRoutine(const SetupProcessor::ClipState &state) : state(state)
+	{
+		routine = 0;
+	}
+
+	ClipRoutine::~ClipRoutine()
+	{
+	}
+
+	void ClipRoutine::generate()
+	{
+		Function<Bool(Pointer<Byte>, Int, Pointer<Byte>)> function;
+		{
+			Pointer<Byte> polygon(function.Arg<0>());
+			Int clipFlagsOr(function.Arg<1>());
+			Pointer<Byte> data(function.Arg<2>());
+
+			float n = symmetricNormalizedDepth ? -1.0f : 0.0f;   // Near clip plane distance
+
+			// Planes as the coefficients of the signed distance to them, in the same order as Clipper::ClipFlags
+			const float frustum[6][4] =
+			{
+				{-1.0f,  0.0f,  0.0f, 1.0f},   // Right
+				{ 0.0f, -1.0f,  0.0f, 1.0f},   // Top
+				{ 0.0f,  0.0f, -1.0f, 1.0f},   // Far
+				{ 1.0f,  0.0f,  0.0f, 1.0f},   // Left
+				{ 0.0f,  1.0f,  0.0f, 1.0f},   // Bottom
+				{ 0.0f,  0.0f,  1.0f, -n},     // Near
+			};
+
+			If((clipFlagsOr & Clipper::CLIP_FRUSTUM) != 0)
+			{
+				static const int order[6] = {5, 2, 3, 0, 1, 4};   // Near, far, left, right, top, bottom
+
+				for(int i : order)
+				{
+					If((clipFlagsOr & (1 << i)) != 0)
+					{
+						clipPlane(polygon, Float4(frustum[i][0], frustum[i][1], frustum[i][2], frustum[i][3]));
+					}
+				}
+			}
+
+			if(state.clipFlags & Clipper::CLIP_USER)
+			{
+				If((clipFlagsOr & Clipper::CLIP_USER) != 0)
+				{
+					for(int i = 0; i < MAX_CLIP_PLANES; i++)
+					{
+						if(state.clipFlags & (Clipper::CLIP_PLANE0 << i))
+						{
+							clipPlane(polygon, *Pointer<Float4>(data + OFFSET(DrawData,clipPlane) + i * sizeof(Plane)));
+						}
+					}
+				}
+			}
+
+			If(*Pointer<Int>(polygon + OFFSET(Polygon,n)) < 3)
+			{
+				Return(false);
+			}
+
+			Return(true);
+		}
+
+		routine = function(L"ClipRoutine");
+	}
+
+	void ClipRoutine::clipPlane(Pointer<Byte> &polygon, const Float4 &plane)
+	{
+		Int n = *Pointer<Int>(polygon + OFFSET(Polygon,n));
+
+		If(n >= 3)
+		{
+			Int i = *Pointer<Int>(polygon + OFFSET(Polygon,i));
+			Int b = *Pointer<Int>(polygon + OFFSET(Polygon,b));
+
+			Pointer<Byte> V = polygon + OFFSET(Polygon,P) + i * Int(sizeof(void*) * 16);
+			Pointer<Byte> T = V + sizeof(void*) * 16;
+
+			Pointer<Byte> V0 = *Pointer<Pointer<Byte>>(V);
+			Float4 P0 = *Pointer<Float4>(V0, 16);
+			Float d0 = distance(P0, plane);
+
+			Pointer<Byte> Vi = V0;
+			Float4 Pi = P0;
+			Float di = d0;
+
+			Int t = 0;
+
+			For(Int k = 1, k <= n, k++)
+			{
+				// The edge to the next vertex, wrapping around to the first one
+				Pointer<Byte> Vj = V0;
+				Float4 Pj = P0;
+				Float dj = d0;
+
+				If(k < n)
+				{
+					Vj = *Pointer<Pointer<Byte>>(V + k * Int(sizeof(void*)));
+					Pj = *Pointer<Float4>(Vj, 16);
+					dj = distance(Pj, plane);
+				}
+
+				Bool inside = di >= 0.0f;
+				Bool crossing = IfThenElse(inside, dj < 0.0f, dj > 0.0f);
+
+				If(inside)
+				{
+					*Pointer<Pointer<Byte>>(T + t * Int(sizeof(void*))) = Vi;
+					t++;
+				}
+
+				If(crossing)
+				{
+					// Intersection, computed from the inside vertex towards the outside one.
+					// Not using vector selects, which Subzero can't encode with a scalar condition.
+					Float4 Pa = Pj;
+					Float4 Pb = Pi;
+					Float da = dj;
+					Float db = di;
+
+					If(inside)
+					{
+						Pa = Pi;
+						Pb = Pj;
+						da = di;
+						db = dj;
+					}
+
+					Float D = 1.0f / (db - da);
+
+					Pointer<Byte> Vo = polygon + OFFSET(Polygon,B) + b * Int(sizeof(float4));
+					*Pointer<Float4>(Vo, 16) = (Float4(db) * Pa - Float4(da) * Pb) * Float4(D);
+
+					*Pointer<Pointer<Byte>>(T + t * Int(sizeof(void*))) = Vo;
+					t++;
+					b++;
+				}
+
+				Vi = Vj;
+				Pi = Pj;
+				di = dj;
+			}
+
+			*Pointer<Int>(polygon + OFFSET(Polygon,n)) = t;
+			*Pointer<Int>(polygon + OFFSET(Polygon,i)) = i + 1;
+			*Pointer<Int>(polygon + OFFSET(Polygon,b)) = b;
+		}
+	}
+
+	Float ClipRoutine::distance(const Float4 &P, const Float4 &plane)
+	{
+		Float4 d = P * plane;
+
+		return Extract(d, 0) + Extract(d, 1) + Extract(d, 2) + Extract(d, 3);   // Same order as scalar evaluation
+	}
+
+	Routine *ClipRoutine::getRoutine()
+	{
+		return routine;
+	}
+}
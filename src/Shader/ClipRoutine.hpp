@@ -0,0 +1,45 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef sw_ClipRoutine_hpp
+#define sw_ClipRoutine_hpp
+
+#include "Renderer/SetupProcessor.hpp"
+#include "Reactor/Reactor.hpp"
+
+namespace sw
+{
+	// Clips a Polygon against the frustum planes in the clip flags it's called with,
+	// and the user planes it was generated for.
+	class ClipRoutine
+	{
+	public:
+		ClipRoutine(const SetupProcessor::ClipState &state);
+
+		virtual ~ClipRoutine();
+
+		void generate();
+		Routine *getRoutine();
+
+	private:
+		void clipPlane(Pointer<Byte> &polygon, const Float4 &plane);
+		Float distance(const Float4 &P, const Float4 &plane);
+
+		const SetupProcessor::ClipState &state;
+
+		Routine *routine;
+	};
+}
+
+#endif   // sw_ClipRoutine_hpp
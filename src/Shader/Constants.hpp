@@ -93,6 +93,7 @@ namespace sw
 		dword minY[16];
 		dword minZ[16];
 		dword fini[16];
+		dword guard[16];
 
 		dword4 maxPos;
 
@@ -989,6 +989,26 @@ namespace sw
 		}
 	}
 
+	void PixelRoutine::blendSwitch(int offset, int value, int last, const std::function<void(int)> &emit)
+	{
+		if(!state.dynamicBlend)
+		{
+			emit(value);
+			return;
+		}
+
+		// Emit the code for every possible value, selected by the one in the draw data
+		Int dynamicValue = *Pointer<Int>(data + offset);
+
+		for(int i = 0; i <= last; i++)
+		{
+			If(dynamicValue == Int(i))
+			{
+				emit(i);
+			}
+		}
+	}
+
 	bool PixelRoutine::isSRGB(int index) const
 	{
 		return Surface::isSRGBformat(state.targetFormat[index]);
@@ -1169,11 +1189,21 @@ namespace sw
 
 	void PixelRoutine::alphaBlend(int index, Pointer<Byte> &cBuffer, Vector4s &current, Int &x)
 	{
-		if(!state.alphaBlendActive)
+		if(state.dynamicBlend)
 		{
-			return;
+			If(*Pointer<Int>(data + OFFSET(DrawData,blend.alphaBlendActive)) != Int(0))
+			{
+				applyBlend(index, cBuffer, current, x);
+			}
 		}
+		else if(state.alphaBlendActive)
+		{
+			applyBlend(index, cBuffer, current, x);
+		}
+	}
 
+	void PixelRoutine::applyBlend(int index, Pointer<Byte> &cBuffer, Vector4s &current, Int &x)
+	{
 		Vector4s pixel;
 		readPixel(index, cBuffer, x, pixel);
 
@@ -1181,109 +1211,139 @@ namespace sw
 		Vector4s sourceFactor;
 		Vector4s destFactor;
 
-		blendFactor(sourceFactor, current, pixel, state.sourceBlendFactor);
-		blendFactor(destFactor, current, pixel, state.destBlendFactor);
+		blendSwitch(OFFSET(DrawData,blend.sourceBlendFactor), state.sourceBlendFactor, BLEND_LAST, [&](int factor)
+		{
+			blendFactor(sourceFactor, current, pixel, (BlendFactor)factor);
+		});
+		blendSwitch(OFFSET(DrawData,blend.destBlendFactor), state.destBlendFactor, BLEND_LAST, [&](int factor)
+		{
+			blendFactor(destFactor, current, pixel, (BlendFactor)factor);
+		});
 
-		if(state.sourceBlendFactor != BLEND_ONE && state.sourceBlendFactor != BLEND_ZERO)
+		blendSwitch(OFFSET(DrawData,blend.sourceBlendFactor), state.sourceBlendFactor, BLEND_LAST, [&](int factor)
 		{
-			current.x = MulHigh(As<UShort4>(current.x), As<UShort4>(sourceFactor.x));
-			current.y = MulHigh(As<UShort4>(current.y), As<UShort4>(sourceFactor.y));
-			current.z = MulHigh(As<UShort4>(current.z), As<UShort4>(sourceFactor.z));
-		}
+			if(factor != BLEND_ONE && factor != BLEND_ZERO)
+			{
+				current.x = MulHigh(As<UShort4>(current.x), As<UShort4>(sourceFactor.x));
+				current.y = MulHigh(As<UShort4>(current.y), As<UShort4>(sourceFactor.y));
+				current.z = MulHigh(As<UShort4>(current.z), As<UShort4>(sourceFactor.z));
+			}
+		});
 
-		if(state.destBlendFactor != BLEND_ONE && state.destBlendFactor != BLEND_ZERO)
+		blendSwitch(OFFSET(DrawData,blend.destBlendFactor), state.destBlendFactor, BLEND_LAST, [&](int factor)
 		{
-			pixel.x = MulHigh(As<UShort4>(pixel.x), As<UShort4>(destFactor.x));
-			pixel.y = MulHigh(As<UShort4>(pixel.y), As<UShort4>(destFactor.y));
-			pixel.z = MulHigh(As<UShort4>(pixel.z), As<UShort4>(destFactor.z));
-		}
+			if(factor != BLEND_ONE && factor != BLEND_ZERO)
+			{
+				pixel.x = MulHigh(As<UShort4>(pixel.x), As<UShort4>(destFactor.x));
+				pixel.y = MulHigh(As<UShort4>(pixel.y), As<UShort4>(destFactor.y));
+				pixel.z = MulHigh(As<UShort4>(pixel.z), As<UShort4>(destFactor.z));
+			}
+		});
 
-		switch(state.blendOperation)
+		blendSwitch(OFFSET(DrawData,blend.blendOperation), state.blendOperation, BLENDOP_LAST, [&](int operation)
 		{
-		case BLENDOP_ADD:
-			current.x = AddSat(As<UShort4>(current.x), As<UShort4>(pixel.x));
-			current.y = AddSat(As<UShort4>(current.y), As<UShort4>(pixel.y));
-			current.z = AddSat(As<UShort4>(current.z), As<UShort4>(pixel.z));
-			break;
-		case BLENDOP_SUB:
-			current.x = SubSat(As<UShort4>(current.x), As<UShort4>(pixel.x));
-			current.y = SubSat(As<UShort4>(current.y), As<UShort4>(pixel.y));
-			current.z = SubSat(As<UShort4>(current.z), As<UShort4>(pixel.z));
-			break;
-		case BLENDOP_INVSUB:
-			current.x = SubSat(As<UShort4>(pixel.x), As<UShort4>(current.x));
-			current.y = SubSat(As<UShort4>(pixel.y), As<UShort4>(current.y));
-			current.z = SubSat(As<UShort4>(pixel.z), As<UShort4>(current.z));
-			break;
-		case BLENDOP_MIN:
-			current.x = Min(As<UShort4>(current.x), As<UShort4>(pixel.x));
-			current.y = Min(As<UShort4>(current.y), As<UShort4>(pixel.y));
-			current.z = Min(As<UShort4>(current.z), As<UShort4>(pixel.z));
-			break;
-		case BLENDOP_MAX:
-			current.x = Max(As<UShort4>(current.x), As<UShort4>(pixel.x));
-			current.y = Max(As<UShort4>(current.y), As<UShort4>(pixel.y));
-			current.z = Max(As<UShort4>(current.z), As<UShort4>(pixel.z));
-			break;
-		case BLENDOP_SOURCE:
-			// No operation
-			break;
-		case BLENDOP_DEST:
-			current.x = pixel.x;
-			current.y = pixel.y;
-			current.z = pixel.z;
-			break;
-		case BLENDOP_NULL:
-			current.x = Short4(0x0000);
-			current.y = Short4(0x0000);
-			current.z = Short4(0x0000);
-			break;
-		default:
-			ASSERT(false);
-		}
+			switch((BlendOperation)operation)
+			{
+			case BLENDOP_ADD:
+				current.x = AddSat(As<UShort4>(current.x), As<UShort4>(pixel.x));
+				current.y = AddSat(As<UShort4>(current.y), As<UShort4>(pixel.y));
+				current.z = AddSat(As<UShort4>(current.z), As<UShort4>(pixel.z));
+				break;
+			case BLENDOP_SUB:
+				current.x = SubSat(As<UShort4>(current.x), As<UShort4>(pixel.x));
+				current.y = SubSat(As<UShort4>(current.y), As<UShort4>(pixel.y));
+				current.z = SubSat(As<UShort4>(current.z), As<UShort4>(pixel.z));
+				break;
+			case BLENDOP_INVSUB:
+				current.x = SubSat(As<UShort4>(pixel.x), As<UShort4>(current.x));
+				current.y = SubSat(As<UShort4>(pixel.y), As<UShort4>(current.y));
+				current.z = SubSat(As<UShort4>(pixel.z), As<UShort4>(current.z));
+				break;
+			case BLENDOP_MIN:
+				current.x = Min(As<UShort4>(current.x), As<UShort4>(pixel.x));
+				current.y = Min(As<UShort4>(current.y), As<UShort4>(pixel.y));
+				current.z = Min(As<UShort4>(current.z), As<UShort4>(pixel.z));
+				break;
+			case BLENDOP_MAX:
+				current.x = Max(As<UShort4>(current.x), As<UShort4>(pixel.x));
+				current.y = Max(As<UShort4>(current.y), As<UShort4>(pixel.y));
+				current.z = Max(As<UShort4>(current.z), As<UShort4>(pixel.z));
+				break;
+			case BLENDOP_SOURCE:
+				// No operation
+				break;
+			case BLENDOP_DEST:
+				current.x = pixel.x;
+				current.y = pixel.y;
+				current.z = pixel.z;
+				break;
+			case BLENDOP_NULL:
+				current.x = Short4(0x0000);
+				current.y = Short4(0x0000);
+				current.z = Short4(0x0000);
+				break;
+			default:
+				ASSERT(false);
+			}
+		});
 
-		blendFactorAlpha(sourceFactor, current, pixel, state.sourceBlendFactorAlpha);
-		blendFactorAlpha(destFactor, current, pixel, state.destBlendFactorAlpha);
+		blendSwitch(OFFSET(DrawData,blend.sourceBlendFactorAlpha), state.sourceBlendFactorAlpha, BLEND_LAST, [&](int factor)
+		{
+			blendFactorAlpha(sourceFactor, current, pixel, (BlendFactor)factor);
+		});
+		blendSwitch(OFFSET(DrawData,blend.destBlendFactorAlpha), state.destBlendFactorAlpha, BLEND_LAST, [&](int factor)
+		{
+			blendFactorAlpha(destFactor, current, pixel, (BlendFactor)factor);
+		});
 
-		if(state.sourceBlendFactorAlpha != BLEND_ONE && state.sourceBlendFactorAlpha != BLEND_ZERO)
+		blendSwitch(OFFSET(DrawData,blend.sourceBlendFactorAlpha), state.sourceBlendFactorAlpha, BLEND_LAST, [&](int factor)
 		{
-			current.w = MulHigh(As<UShort4>(current.w), As<UShort4>(sourceFactor.w));
-		}
+			if(factor != BLEND_ONE && factor != BLEND_ZERO)
+			{
+				current.w = MulHigh(As<UShort4>(current.w), As<UShort4>(sourceFactor.w));
+			}
+		});
 
-		if(state.destBlendFactorAlpha != BLEND_ONE && state.destBlendFactorAlpha != BLEND_ZERO)
+		blendSwitch(OFFSET(DrawData,blend.destBlendFactorAlpha), state.destBlendFactorAlpha, BLEND_LAST, [&](int factor)
 		{
-			pixel.w = MulHigh(As<UShort4>(pixel.w), As<UShort4>(destFactor.w));
-		}
+			if(factor != BLEND_ONE && factor != BLEND_ZERO)
+			{
+				pixel.w = MulHigh(As<UShort4>(pixel.w), As<UShort4>(destFactor.w));
+			}
+		});
 
-		switch(state.blendOperationAlpha)
+		blendSwitch(OFFSET(DrawData,blend.blendOperationAlpha), state.blendOperationAlpha, BLENDOP_LAST, [&](int operation)
 		{
-		case BLENDOP_ADD:
-			current.w = AddSat(As<UShort4>(current.w), As<UShort4>(pixel.w));
-			break;
-		case BLENDOP_SUB:
-			current.w = SubSat(As<UShort4>(current.w), As<UShort4>(pixel.w));
-			break;
-		case BLENDOP_INVSUB:
-			current.w = SubSat(As<UShort4>(pixel.w), As<UShort4>(current.w));
-			break;
-		case BLENDOP_MIN:
-			current.w = Min(As<UShort4>(current.w), As<UShort4>(pixel.w));
-			break;
-		case BLENDOP_MAX:
-			current.w = Max(As<UShort4>(current.w), As<UShort4>(pixel.w));
-			break;
-		case BLENDOP_SOURCE:
-			// No operation
-			break;
-		case BLENDOP_DEST:
-			current.w = pixel.w;
-			break;
-		case BLENDOP_NULL:
-			current.w = Short4(0x0000);
-			break;
-		default:
-			ASSERT(false);
-		}
+			switch((BlendOperation)operation)
+			{
+			case BLENDOP_ADD:
+				current.w = AddSat(As<UShort4>(current.w), As<UShort4>(pixel.w));
+				break;
+			case BLENDOP_SUB:
+				current.w = SubSat(As<UShort4>(current.w), As<UShort4>(pixel.w));
+				break;
+			case BLENDOP_INVSUB:
+				current.w = SubSat(As<UShort4>(pixel.w), As<UShort4>(current.w));
+				break;
+			case BLENDOP_MIN:
+				current.w = Min(As<UShort4>(current.w), As<UShort4>(pixel.w));
+				break;
+			case BLENDOP_MAX:
+				current.w = Max(As<UShort4>(current.w), As<UShort4>(pixel.w));
+				break;
+			case BLENDOP_SOURCE:
+				// No operation
+				break;
+			case BLENDOP_DEST:
+				current.w = pixel.w;
+				break;
+			case BLENDOP_NULL:
+				current.w = Short4(0x0000);
+				break;
+			default:
+				ASSERT(false);
+			}
+		});
 	}
 
 	void PixelRoutine::logicOperation(int index, Pointer<Byte> &cBuffer, Vector4s &current, Int &x)
@@ -2028,11 +2088,21 @@ namespace sw
 
 	void PixelRoutine::alphaBlend(int index, Pointer<Byte> &cBuffer, Vector4f &oC, Int &x)
 	{
-		if(!state.alphaBlendActive)
+		if(state.dynamicBlend)
 		{
-			return;
+			If(*Pointer<Int>(data + OFFSET(DrawData,blend.alphaBlendActive)) != Int(0))
+			{
+				applyBlend(index, cBuffer, oC, x);
+			}
 		}
+		else if(state.alphaBlendActive)
+		{
+			applyBlend(index, cBuffer, oC, x);
+		}
+	}
 
+	void PixelRoutine::applyBlend(int index, Pointer<Byte> &cBuffer, Vector4f &oC, Int &x)
+	{
 		Pointer<Byte> buffer;
 		Vector4f pixel;
 
@@ -2111,110 +2181,140 @@ namespace sw
 		Vector4f sourceFactor;
 		Vector4f destFactor;
 
-		blendFactor(sourceFactor, oC, pixel, state.sourceBlendFactor);
-		blendFactor(destFactor, oC, pixel, state.destBlendFactor);
+		blendSwitch(OFFSET(DrawData,blend.sourceBlendFactor), state.sourceBlendFactor, BLEND_LAST, [&](int factor)
+		{
+			blendFactor(sourceFactor, oC, pixel, (BlendFactor)factor);
+		});
+		blendSwitch(OFFSET(DrawData,blend.destBlendFactor), state.destBlendFactor, BLEND_LAST, [&](int factor)
+		{
+			blendFactor(destFactor, oC, pixel, (BlendFactor)factor);
+		});
 
-		if(state.sourceBlendFactor != BLEND_ONE && state.sourceBlendFactor != BLEND_ZERO)
+		blendSwitch(OFFSET(DrawData,blend.sourceBlendFactor), state.sourceBlendFactor, BLEND_LAST, [&](int factor)
 		{
-			oC.x *= sourceFactor.x;
-			oC.y *= sourceFactor.y;
-			oC.z *= sourceFactor.z;
-		}
+			if(factor != BLEND_ONE && factor != BLEND_ZERO)
+			{
+				oC.x *= sourceFactor.x;
+				oC.y *= sourceFactor.y;
+				oC.z *= sourceFactor.z;
+			}
+		});
 
-		if(state.destBlendFactor != BLEND_ONE && state.destBlendFactor != BLEND_ZERO)
+		blendSwitch(OFFSET(DrawData,blend.destBlendFactor), state.destBlendFactor, BLEND_LAST, [&](int factor)
 		{
-			pixel.x *= destFactor.x;
-			pixel.y *= destFactor.y;
-			pixel.z *= destFactor.z;
-		}
+			if(factor != BLEND_ONE && factor != BLEND_ZERO)
+			{
+				pixel.x *= destFactor.x;
+				pixel.y *= destFactor.y;
+				pixel.z *= destFactor.z;
+			}
+		});
 
-		switch(state.blendOperation)
+		blendSwitch(OFFSET(DrawData,blend.blendOperation), state.blendOperation, BLENDOP_LAST, [&](int operation)
 		{
-		case BLENDOP_ADD:
-			oC.x += pixel.x;
-			oC.y += pixel.y;
-			oC.z += pixel.z;
-			break;
-		case BLENDOP_SUB:
-			oC.x -= pixel.x;
-			oC.y -= pixel.y;
-			oC.z -= pixel.z;
-			break;
-		case BLENDOP_INVSUB:
-			oC.x = pixel.x - oC.x;
-			oC.y = pixel.y - oC.y;
-			oC.z = pixel.z - oC.z;
-			break;
-		case BLENDOP_MIN:
-			oC.x = Min(oC.x, pixel.x);
-			oC.y = Min(oC.y, pixel.y);
-			oC.z = Min(oC.z, pixel.z);
-			break;
-		case BLENDOP_MAX:
-			oC.x = Max(oC.x, pixel.x);
-			oC.y = Max(oC.y, pixel.y);
-			oC.z = Max(oC.z, pixel.z);
-			break;
-		case BLENDOP_SOURCE:
-			// No operation
-			break;
-		case BLENDOP_DEST:
-			oC.x = pixel.x;
-			oC.y = pixel.y;
-			oC.z = pixel.z;
-			break;
-		case BLENDOP_NULL:
-			oC.x = Float4(0.0f);
-			oC.y = Float4(0.0f);
-			oC.z = Float4(0.0f);
-			break;
-		default:
-			ASSERT(false);
-		}
+			switch((BlendOperation)operation)
+			{
+			case BLENDOP_ADD:
+				oC.x += pixel.x;
+				oC.y += pixel.y;
+				oC.z += pixel.z;
+				break;
+			case BLENDOP_SUB:
+				oC.x -= pixel.x;
+				oC.y -= pixel.y;
+				oC.z -= pixel.z;
+				break;
+			case BLENDOP_INVSUB:
+				oC.x = pixel.x - oC.x;
+				oC.y = pixel.y - oC.y;
+				oC.z = pixel.z - oC.z;
+				break;
+			case BLENDOP_MIN:
+				oC.x = Min(oC.x, pixel.x);
+				oC.y = Min(oC.y, pixel.y);
+				oC.z = Min(oC.z, pixel.z);
+				break;
+			case BLENDOP_MAX:
+				oC.x = Max(oC.x, pixel.x);
+				oC.y = Max(oC.y, pixel.y);
+				oC.z = Max(oC.z, pixel.z);
+				break;
+			case BLENDOP_SOURCE:
+				// No operation
+				break;
+			case BLENDOP_DEST:
+				oC.x = pixel.x;
+				oC.y = pixel.y;
+				oC.z = pixel.z;
+				break;
+			case BLENDOP_NULL:
+				oC.x = Float4(0.0f);
+				oC.y = Float4(0.0f);
+				oC.z = Float4(0.0f);
+				break;
+			default:
+				ASSERT(false);
+			}
+		});
 
-		blendFactorAlpha(sourceFactor, oC, pixel, state.sourceBlendFactorAlpha);
-		blendFactorAlpha(destFactor, oC, pixel, state.destBlendFactorAlpha);
+		blendSwitch(OFFSET(DrawData,blend.sourceBlendFactorAlpha), state.sourceBlendFactorAlpha, BLEND_LAST, [&](int factor)
+		{
+			blendFactorAlpha(sourceFactor, oC, pixel, (BlendFactor)factor);
+		});
+		blendSwitch(OFFSET(DrawData,blend.destBlendFactorAlpha), state.destBlendFactorAlpha, BLEND_LAST, [&](int factor)
+		{
+			blendFactorAlpha(destFactor, oC, pixel, (BlendFactor)factor);
+		});
 
-		if(state.sourceBlendFactorAlpha != BLEND_ONE && state.sourceBlendFactorAlpha != BLEND_ZERO)
+		blendSwitch(OFFSET(DrawData,blend.sourceBlendFactorAlpha), state.sourceBlendFactorAlpha, BLEND_LAST, [&](int factor)
 		{
-			oC.w *= sourceFactor.w;
-		}
+			if(factor != BLEND_ONE && factor != BLEND_ZERO)
+			{
+				oC.w *= sourceFactor.w;
+			}
+		});
 
-		if(state.destBlendFactorAlpha != BLEND_ONE && state.destBlendFactorAlpha != BLEND_ZERO)
+		blendSwitch(OFFSET(DrawData,blend.destBlendFactorAlpha), state.destBlendFactorAlpha, BLEND_LAST, [&](int factor)
 		{
-			pixel.w *= destFactor.w;
-		}
+			if(factor != BLEND_ONE && factor != BLEND_ZERO)
+			{
+				pixel.w *= destFactor.w;
+			}
+		});
 
-		switch(state.blendOperationAlpha)
+		blendSwitch(OFFSET(DrawData,blend.blendOperationAlpha), state.blendOperationAlpha, BLENDOP_LAST, [&](int operation)
 		{
-		case BLENDOP_ADD:
-			oC.w += pixel.w;
-			break;
-		case BLENDOP_SUB:
-			oC.w -= pixel.w;
-			break;
-		case BLENDOP_INVSUB:
-			pixel.w -= oC.w;
-			oC.w = pixel.w;
-			break;
-		case BLENDOP_MIN:
-			oC.w = Min(oC.w, pixel.w);
-			break;
-		case BLENDOP_MAX:
-			oC.w = Max(oC.w, pixel.w);
-			break;
-		case BLENDOP_SOURCE:
-			// No operation
-			break;
-		case BLENDOP_DEST:
-			oC.w = pixel.w;
-			break;
-		case BLENDOP_NULL:
-			oC.w = Float4(0.0f);
-			break;
-		default:
-			ASSERT(false);
-		}
+			switch((BlendOperation)operation)
+			{
+			case BLENDOP_ADD:
+				oC.w += pixel.w;
+				break;
+			case BLENDOP_SUB:
+				oC.w -= pixel.w;
+				break;
+			case BLENDOP_INVSUB:
+				pixel.w -= oC.w;
+				oC.w = pixel.w;
+				break;
+			case BLENDOP_MIN:
+				oC.w = Min(oC.w, pixel.w);
+				break;
+			case BLENDOP_MAX:
+				oC.w = Max(oC.w, pixel.w);
+				break;
+			case BLENDOP_SOURCE:
+				// No operation
+				break;
+			case BLENDOP_DEST:
+				oC.w = pixel.w;
+				break;
+			case BLENDOP_NULL:
+				oC.w = Float4(0.0f);
+				break;
+			default:
+				ASSERT(false);
+			}
+		});
 	}
 
 	void PixelRoutine::writeColor(int index, Pointer<Byte> &cBuffer, Int &x, Vector4f &oC, Int &sMask, Int &zMask, Int &cMask)
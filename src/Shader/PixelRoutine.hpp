@@ -17,6 +17,8 @@
 
 #include "Renderer/QuadRasterizer.hpp"
 
+#include <functional>
+
 namespace sw
 {
 	class PixelShader;
@@ -74,6 +76,9 @@ namespace sw
 		Bool depthTest(Pointer<Byte> &zBuffer, int q, Int &x, Float4 &z, Int &sMask, Int &zMask, Int &cMask);
 
 		// Raster operations
+		void applyBlend(int index, Pointer<Byte> &cBuffer, Vector4s &current, Int &x);
+		void applyBlend(int index, Pointer<Byte> &cBuffer, Vector4f &oC, Int &x);
+		void blendSwitch(int offset, int value, int last, const std::function<void(int)> &emit);   // Emits code for the state's blend value, or the draw's with dynamic blending
 		void blendFactor(Vector4s &blendFactor, const Vector4s &current, const Vector4s &pixel, BlendFactor blendFactorActive);
 		void blendFactorAlpha(Vector4s &blendFactor, const Vector4s &current, const Vector4s &pixel, BlendFactor blendFactorAlphaActive);
 		void readPixel(int index, Pointer<Byte> &cBuffer, Int &x, Vector4s &pixel);
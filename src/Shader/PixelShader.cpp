@@ -22,13 +22,18 @@ namespace sw
 {
 	PixelShader::PixelShader(const PixelShader *ps) : Shader()
 	{
+		shaderType = SHADER_PIXEL;
 		shaderModel = 0x0300;
 		vPosDeclared = false;
 		vFaceDeclared = false;
+		zOverride = false;
+		kill = false;
 		centroid = false;
 
 		if(ps)   // Make a copy
 		{
+			shaderModel = ps->shaderModel;
+
 			for(size_t i = 0; i < ps->getLength(); i++)
 			{
 				append(new sw::Shader::Instruction(*ps->getInstruction(i)));
@@ -44,6 +49,16 @@ namespace sw
 		}
 	}
 
+	PixelShader::PixelShader(const PixelShader &ps) : Shader(ps)
+	{
+		memcpy(input, ps.input, sizeof(input));
+		vPosDeclared = ps.vPosDeclared;
+		vFaceDeclared = ps.vFaceDeclared;
+		zOverride = ps.zOverride;
+		kill = ps.kill;
+		centroid = ps.centroid;
+	}
+
 	PixelShader::PixelShader(const unsigned long *token) : Shader()
 	{
 		parse(token);
@@ -743,4 +758,20 @@ namespace sw
 			}
 		}
 	}
+
+	void PixelShader::hashData(std::vector<unsigned int> &data) const
+	{
+		Shader::hashData(data);
+
+		for(int i = 0; i < MAX_FRAGMENT_INPUTS; i++)
+		{
+			for(int j = 0; j < 4; j++)
+			{
+				const Semantic &semantic = input[i][j];
+				data.push_back(semantic.usage | semantic.index << 8 | semantic.centroid << 16 | semantic.flat << 17);
+			}
+		}
+
+		data.push_back(vPosDeclared | vFaceDeclared << 1 | zOverride << 2 | kill << 3 | centroid << 4);
+	}
 }
@@ -24,6 +24,7 @@ namespace sw
 	{
 	public:
 		explicit PixelShader(const PixelShader *ps = 0);
+		PixelShader(const PixelShader &ps);   // Copies a linked shader without reanalyzing it
 		explicit PixelShader(const unsigned long *token);
 
 		virtual ~PixelShader();
@@ -50,6 +51,8 @@ namespace sw
 		void analyzeKill();
 		void analyzeInterpolants();
 
+		void hashData(std::vector<unsigned int> &data) const override;
+
 		Semantic input[MAX_FRAGMENT_INPUTS][4];
 
 		bool vPosDeclared;
@@ -163,9 +163,11 @@ namespace sw
 				Until(i >= n)
 			}
 
-			// Vertical range
+			// Vertical and horizontal range
 			Int yMin = Y[0];
 			Int yMax = Y[0];
+			Int xMin = X[0];
+			Int xMax = X[0];
 
 			Int i = 1;
 
@@ -173,6 +175,8 @@ namespace sw
 			{
 				yMin = Min(Y[i], yMin);
 				yMax = Max(Y[i], yMax);
+				xMin = Min(X[i], xMin);
+				xMax = Max(X[i], xMax);
 
 				i++;
 			}
@@ -197,6 +201,17 @@ namespace sw
 			yMin = Max(yMin, *Pointer<Int>(data + OFFSET(DrawData,scissorY0)));
 			yMax = Min(yMax, *Pointer<Int>(data + OFFSET(DrawData,scissorY1)));
 
+			If(yMin >= yMax)
+			{
+				Return(false);
+			}
+
+			// Each sample's outline gets an even number of rows from yLow to yMax + 1,
+			// packed into the storage provided by the renderer
+			Int yLow = (yMin - 1) & Int(~1);
+			Int height = (yMax + 3 - yLow) & Int(~1);
+			Pointer<Byte> outline = *Pointer<Pointer<Byte>>(primitive + OFFSET(Primitive,outline));
+
 			For(Int q = 0, q < state.multiSample, q++)
 			{
 				Array<Int> Xq(16);
@@ -219,8 +234,11 @@ namespace sw
 				}
 				Until(i >= n)
 
-				Pointer<Byte> leftEdge = Pointer<Byte>(primitive + OFFSET(Primitive,outline->left)) + q * sizeof(Primitive);
-				Pointer<Byte> rightEdge = Pointer<Byte>(primitive + OFFSET(Primitive,outline->right)) + q * sizeof(Primitive);
+				Pointer<Byte> outlineq = outline + (q * height - yLow) * sizeof(Primitive::Span);
+				*Pointer<Pointer<Byte>>(primitive + q * sizeof(Primitive) + OFFSET(Primitive,outline)) = outlineq;
+
+				Pointer<Byte> leftEdge = outlineq + OFFSET(Primitive::Span,left);
+				Pointer<Byte> rightEdge = outlineq + OFFSET(Primitive::Span,right);
 
 				if(state.multiSample > 1)
 				{
@@ -278,6 +296,13 @@ namespace sw
 			*Pointer<Int>(primitive + OFFSET(Primitive,yMin)) = yMin;
 			*Pointer<Int>(primitive + OFFSET(Primitive,yMax)) = yMax;
 
+			// Conservative horizontal bounds, with a pixel of margin for multisample offsets
+			xMin = Max((xMin >> 4) - 1, *Pointer<Int>(data + OFFSET(DrawData,scissorX0)));
+			xMax = Min(((xMax + 0xF) >> 4) + 1, *Pointer<Int>(data + OFFSET(DrawData,scissorX1)));
+
+			*Pointer<Int>(primitive + OFFSET(Primitive,xMin)) = xMin;
+			*Pointer<Int>(primitive + OFFSET(Primitive,xMax)) = xMax;
+
 			// Sort by minimum y
 			if(solidTriangle && logPrecision >= WHQL)
 			{
@@ -576,8 +601,9 @@ namespace sw
 				Int xMin = *Pointer<Int>(data + OFFSET(DrawData,scissorX0));
 				Int xMax = *Pointer<Int>(data + OFFSET(DrawData,scissorX1));
 
-				Pointer<Byte> leftEdge = primitive + q * sizeof(Primitive) + OFFSET(Primitive,outline->left);
-				Pointer<Byte> rightEdge = primitive + q * sizeof(Primitive) + OFFSET(Primitive,outline->right);
+				Pointer<Byte> outline = *Pointer<Pointer<Byte>>(primitive + q * sizeof(Primitive) + OFFSET(Primitive,outline));
+				Pointer<Byte> leftEdge = outline + OFFSET(Primitive::Span,left);
+				Pointer<Byte> rightEdge = outline + OFFSET(Primitive::Span,right);
 				Pointer<Byte> edge = IfThenElse(swap, rightEdge, leftEdge);
 
 				// Deltas
@@ -1129,9 +1129,46 @@ namespace sw
 		       analysisLeave;
 	}
 
-	Shader::Shader() : serialID(serialCounter++)
+	Shader::Shader() : serialID(serialCounter++), hash(0)
 	{
 		usedSamplers = 0;
+
+		dynamicallyIndexedTemporaries = false;
+		dynamicallyIndexedInput = false;
+		dynamicallyIndexedOutput = false;
+
+		dynamicBranching = false;
+		containsBreak = false;
+		containsContinue = false;
+		containsLeave = false;
+		containsDefine = false;
+	}
+
+	Shader::Shader(const Shader &shader) : serialID(serialCounter++), hash(0)
+	{
+		shaderType = shader.shaderType;
+		shaderModel = shader.shaderModel;
+
+		for(const auto &inst : shader.instruction)
+		{
+			append(new Instruction(*inst));
+		}
+
+		usedSamplers = shader.usedSamplers;
+
+		dirtyConstantsF = shader.dirtyConstantsF;
+		dirtyConstantsI = shader.dirtyConstantsI;
+		dirtyConstantsB = shader.dirtyConstantsB;
+
+		dynamicallyIndexedTemporaries = shader.dynamicallyIndexedTemporaries;
+		dynamicallyIndexedInput = shader.dynamicallyIndexedInput;
+		dynamicallyIndexedOutput = shader.dynamicallyIndexedOutput;
+
+		dynamicBranching = shader.dynamicBranching;
+		containsBreak = shader.containsBreak;
+		containsContinue = shader.containsContinue;
+		containsLeave = shader.containsLeave;
+		containsDefine = shader.containsDefine;
 	}
 
 	Shader::~Shader()
@@ -1428,6 +1465,76 @@ namespace sw
 		return serialID;
 	}
 
+	static void hashParameter(std::vector<unsigned int> &data, const Shader::Parameter &param)
+	{
+		data.push_back(param.type);
+
+		switch(param.type)
+		{
+		case Shader::PARAMETER_VOID:
+			break;
+		case Shader::PARAMETER_FLOAT4LITERAL:
+		case Shader::PARAMETER_BOOL1LITERAL:
+		case Shader::PARAMETER_INT4LITERAL:
+			data.insert(data.end(), param.integer, param.integer + 4);
+			break;
+		case Shader::PARAMETER_LABEL:
+			data.push_back(param.label);
+			data.push_back(param.callSite);
+			break;
+		default:
+			data.push_back(param.index);
+			data.push_back(param.rel.type);
+			data.push_back(param.rel.index);
+			data.push_back(param.rel.swizzle);
+			data.push_back(param.rel.scale);
+			data.push_back(param.rel.deterministic);
+		}
+	}
+
+	uint64_t Shader::getHash() const
+	{
+		if(hash == 0)
+		{
+			std::vector<unsigned int> data;
+			hashData(data);
+
+			hash = FNV_1a(reinterpret_cast<const unsigned char*>(data.data()), (int)(data.size() * sizeof(unsigned int)));
+		}
+
+		return hash;
+	}
+
+	void Shader::hashData(std::vector<unsigned int> &data) const
+	{
+		// Only hash the fields which affect code generation, since the unions and bit fields contain undefined padding
+		data.push_back(shaderType);
+		data.push_back(shaderModel);
+		data.push_back(usedSamplers);
+		data.push_back(dynamicallyIndexedTemporaries | dynamicallyIndexedInput << 1 | dynamicallyIndexedOutput << 2);
+		data.push_back(dynamicBranching | containsBreak << 1 | containsContinue << 2 | containsLeave << 3 | containsDefine << 4);
+
+		for(const auto &inst : instruction)
+		{
+			data.push_back(inst->opcode);
+			data.push_back(inst->control);
+			data.push_back(inst->predicate | inst->predicateNot << 1 | inst->coissue << 2 | inst->predicateSwizzle << 8);
+			data.push_back(inst->samplerType | inst->usage << 8 | inst->usageIndex << 16);
+			data.push_back(inst->analysis);
+
+			const DestinationParameter &dst = inst->dst;
+			data.push_back(dst.mask | dst.saturate << 4 | dst.partialPrecision << 5 | dst.centroid << 6 | (dst.shift & 0xF) << 8);
+
+			hashParameter(data, dst);
+
+			for(const auto &src : inst->src)
+			{
+				data.push_back(src.swizzle | src.modifier << 8 | (src.bufferIndex & 0xFF) << 16);
+				hashParameter(data, src);
+			}
+		}
+	}
+
 	size_t Shader::getLength() const
 	{
 		return instruction.size();
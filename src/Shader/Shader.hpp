@@ -558,6 +558,7 @@ namespace sw
 		virtual ~Shader();
 
 		int getSerialID() const;
+		uint64_t getHash() const;   // Content hash, equal for identical shaders across processes
 		size_t getLength() const;
 		ShaderType getShaderType() const;
 		unsigned short getShaderModel() const;
@@ -617,6 +618,8 @@ namespace sw
 		bool dynamicallyIndexedOutput;
 
 	protected:
+		Shader(const Shader &shader);   // Copies the instructions and the analysis results
+
 		void parse(const unsigned long *token);
 
 		void optimizeLeave();
@@ -630,6 +633,8 @@ namespace sw
 		void analyzeDynamicIndexing();
 		void markFunctionAnalysis(unsigned int functionLabel, Analysis flag);
 
+		virtual void hashData(std::vector<unsigned int> &data) const;
+
 		ShaderType shaderType;
 
 		union
@@ -651,6 +656,8 @@ namespace sw
 		const int serialID;
 		static volatile int serialCounter;
 
+		mutable uint64_t hash;   // Computed on first use
+
 		bool dynamicBranching;
 		bool containsBreak;
 		bool containsContinue;
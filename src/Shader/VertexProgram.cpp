@@ -21,6 +21,8 @@
 #include "Common/Half.hpp"
 #include "Common/Debug.hpp"
 
+#include <unordered_set>
+
 namespace sw
 {
 	VertexProgram::VertexProgram(const VertexProcessor::State &state, const VertexShader *shader)
@@ -51,7 +53,7 @@ namespace sw
 
 		if(shader->isInstanceIdDeclared())
 		{
-			instanceID = *Pointer<Int>(data + OFFSET(DrawData,instanceID));
+			instanceID = *Pointer<Int>(task + OFFSET(VertexTask,instanceID));
 		}
 	}
 
@@ -100,6 +102,10 @@ namespace sw
 			}
 		}
 
+		// Position-only routines skip the instructions which the position doesn't depend on
+		std::vector<bool> positionDependency;
+		bool skipInstructions = state.positionOnly && positionDependencies(positionDependency);
+
 		// Create all call site return blocks up front
 		for(size_t i = 0; i < shader->getLength(); i++)
 		{
@@ -125,6 +131,11 @@ namespace sw
 				continue;
 			}
 
+			if(skipInstructions && !positionDependency[i])
+			{
+				continue;
+			}
+
 			Dst dst = instruction->dst;
 			Src src0 = instruction->src[0];
 			Src src1 = instruction->src[1];
@@ -651,6 +662,125 @@ namespace sw
 		}
 	}
 
+	bool VertexProgram::positionDependencies(std::vector<bool> &dependency) const
+	{
+		// Registers are tracked as a whole, regardless of control flow, so this is conservative
+		std::unordered_set<unsigned int> needed;
+		auto key = [](Shader::ParameterType type, unsigned int index) { return (unsigned int)type << 24 | index; };
+
+		if(shader->getShaderModel() < 0x0300)
+		{
+			needed.insert(key(Shader::PARAMETER_RASTOUT, 0));
+		}
+		else
+		{
+			needed.insert(key(Shader::PARAMETER_OUTPUT, state.positionRegister));
+		}
+
+		dependency.assign(shader->getLength(), false);
+
+		bool changed = true;
+
+		while(changed)
+		{
+			changed = false;
+
+			for(size_t i = 0; i < shader->getLength(); i++)
+			{
+				const Shader::Instruction *instruction = shader->getInstruction(i);
+				const Dst &dst = instruction->dst;
+
+				if(dependency[i])
+				{
+					continue;
+				}
+
+				bool write = false;
+
+				switch(dst.type)
+				{
+				case Shader::PARAMETER_TEMP:
+				case Shader::PARAMETER_ADDR:
+				case Shader::PARAMETER_RASTOUT:
+				case Shader::PARAMETER_ATTROUT:
+				case Shader::PARAMETER_OUTPUT:
+				case Shader::PARAMETER_PREDICATE:
+					write = true;
+					break;
+				default:
+					break;
+				}
+
+				if(write && !instruction->isBranch() && !instruction->isCall() && !instruction->isBreak() && !instruction->isLoop() && !instruction->isEndLoop())
+				{
+					if(dst.rel.type != Shader::PARAMETER_VOID)
+					{
+						return false;   // Could write any register
+					}
+
+					if(needed.find(key(dst.type, dst.index)) == needed.end())
+					{
+						continue;
+					}
+				}
+
+				// Keep the instruction and everything it reads
+				dependency[i] = true;
+				changed = true;
+
+				if(instruction->predicate)
+				{
+					needed.insert(key(Shader::PARAMETER_PREDICATE, 0));
+				}
+
+				if(dst.rel.type != Shader::PARAMETER_VOID)
+				{
+					needed.insert(key(dst.rel.type, dst.rel.index));
+				}
+
+				for(int j = 0; j < 5; j++)
+				{
+					const Src &src = instruction->src[j];
+
+					if(src.type == Shader::PARAMETER_VOID)
+					{
+						continue;
+					}
+
+					if(src.rel.type != Shader::PARAMETER_VOID)
+					{
+						if(src.type == Shader::PARAMETER_TEMP || src.type == Shader::PARAMETER_OUTPUT)
+						{
+							return false;   // Could read any register
+						}
+
+						needed.insert(key(src.rel.type, src.rel.index));
+					}
+
+					needed.insert(key(src.type, src.index));
+				}
+
+				switch(instruction->opcode)
+				{
+				case Shader::OPCODE_M3X2:
+				case Shader::OPCODE_M3X3:
+				case Shader::OPCODE_M3X4:
+				case Shader::OPCODE_M4X3:
+				case Shader::OPCODE_M4X4:
+					for(unsigned int k = 1; k < 4; k++)   // Rows are consecutive registers
+					{
+						needed.insert(key(instruction->src[1].type, instruction->src[1].index + k));
+					}
+					break;
+				default:
+					break;
+				}
+			}
+		}
+
+		return true;
+	}
+
 	Vector4f VertexProgram::fetchRegister(const Src &src, unsigned int offset)
 	{
 		Vector4f reg;
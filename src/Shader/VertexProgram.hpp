@@ -22,6 +22,8 @@
 #include "Renderer/Stream.hpp"
 #include "Common/Types.hpp"
 
+#include <vector>
+
 namespace sw
 {
 	struct Stream;
@@ -67,6 +69,8 @@ namespace sw
 		void program(UInt &index);
 		void passThrough();
 
+		bool positionDependencies(std::vector<bool> &dependency) const;   // False when they can't be determined
+
 		Vector4f fetchRegister(const Src &src, unsigned int offset = 0);
 		Vector4f readConstant(const Src &src, unsigned int offset = 0);
 		RValue<Pointer<Byte>> uniformAddress(int bufferIndex, unsigned int index);
@@ -41,9 +41,13 @@ namespace sw
 	{
 		const bool textureSampling = state.textureSampling;
 
-		Pointer<Byte> cache = task + OFFSET(VertexTask,vertexCache);
-		Pointer<Byte> vertexCache = cache + OFFSET(VertexCache,vertex);
-		Pointer<Byte> tagCache = cache + OFFSET(VertexCache,tag);
+		Pointer<Byte> cache = task + (state.positionOnly ? OFFSET(VertexTask,positionCache) : OFFSET(VertexTask,vertexCache));
+		Pointer<Byte> vertexCache = *Pointer<Pointer<Byte>>(cache + OFFSET(VertexCache,vertex));
+		Pointer<Byte> tagCache = *Pointer<Pointer<Byte>>(cache + OFFSET(VertexCache,tag));
+		Pointer<Byte> victimCache = *Pointer<Pointer<Byte>>(cache + OFFSET(VertexCache,victim));
+		UInt setMask = *Pointer<UInt>(cache + OFFSET(VertexCache,setMask));
+		UInt ways = *Pointer<UInt>(cache + OFFSET(VertexCache,ways));
+		UInt misses = 0;
 
 		UInt vertexCount = *Pointer<UInt>(task + OFFSET(VertexTask,vertexCount));
 		UInt primitiveNumber = *Pointer<UInt>(task + OFFSET(VertexTask, primitiveStart));
@@ -54,23 +58,39 @@ namespace sw
 		Do
 		{
 			UInt index = *Pointer<UInt>(batch);
-			UInt tagIndex = index & 0x0000003C;
 			UInt indexQ = !textureSampling ? UInt(index & 0xFFFFFFFC) : index;   // FIXME: TEXLDL hack to have independent LODs, hurts performance.
+			UInt set = (!textureSampling ? UInt(index >> 2) : index) & setMask;
+			UInt first = set * ways;
+			UInt line = 0xFFFFFFFF;
 
-			If(*Pointer<UInt>(tagCache + tagIndex) != indexQ)
+			For(UInt way = 0, way < ways, way++)
 			{
-				*Pointer<UInt>(tagCache + tagIndex) = indexQ;
+				If(*Pointer<UInt>(tagCache + (first + way) * UInt((int)sizeof(unsigned int))) == indexQ)
+				{
+					line = first + way;
+				}
+			}
+
+			If(line == 0xFFFFFFFF)
+			{
+				Pointer<UInt> victim = Pointer<UInt>(victimCache + set * UInt((int)sizeof(unsigned int)));
+				line = first + *victim;
+				*victim = (*victim + 1) & (ways - 1);
+
+				*Pointer<UInt>(tagCache + line * UInt((int)sizeof(unsigned int))) = indexQ;
 
 				readInput(indexQ);
 				pipeline(indexQ);
 				postTransform();
 				computeClipFlags();
 
-				Pointer<Byte> cacheLine0 = vertexCache + tagIndex * UInt((int)sizeof(Vertex));
+				Pointer<Byte> cacheLine0 = vertexCache + line * UInt((int)sizeof(Vertex[4]));
 				writeCache(cacheLine0);
+
+				misses++;
 			}
 
-			UInt cacheIndex = index & 0x0000003F;
+			UInt cacheIndex = line * 4 + (index & 0x00000003);
 			Pointer<Byte> cacheLine = vertexCache + cacheIndex * UInt((int)sizeof(Vertex));
 			writeVertex(vertex, cacheLine);
 
@@ -92,6 +112,8 @@ namespace sw
 		}
 		Until(vertexCount == 0)
 
+		*Pointer<UInt>(cache + OFFSET(VertexCache,misses)) = misses;
+
 		Return();
 	}
 
@@ -102,6 +124,16 @@ namespace sw
 			Pointer<Byte> input = *Pointer<Pointer<Byte>>(data + OFFSET(DrawData,input) + sizeof(void*) * i);
 			UInt stride = *Pointer<UInt>(data + OFFSET(DrawData,stride) + sizeof(unsigned int) * i);
 
+			if(state.input[i].instanced)
+			{
+				// All vertices of an instance read the same element
+				UInt instanceID = *Pointer<UInt>(task + OFFSET(VertexTask,instanceID));
+				UInt divisor = *Pointer<UInt>(data + OFFSET(DrawData,divisor) + sizeof(unsigned int) * i);
+
+				input += (instanceID / divisor) * stride;
+				stride = UInt(0);
+			}
+
 			v[i] = readStream(input, stride, state.input[i], index);
 		}
 	}
@@ -131,6 +163,10 @@ namespace sw
 		Int4 finiteXYZ = finiteX & finiteY & finiteZ;
 		clipFlags |= *Pointer<Int>(constants + OFFSET(Constants,fini) + SignMask(finiteXYZ) * 4);
 
+		Float4 guardBand = o[pos].w * *Pointer<Float4>(data + OFFSET(DrawData,guardBand));
+		Int4 outsideXY = CmpNLE(Abs(o[pos].x), guardBand) | CmpNLE(Abs(o[pos].y), guardBand);
+		clipFlags |= *Pointer<Int>(constants + OFFSET(Constants,guard) + SignMask(outsideXY) * 4);
+
 		if(state.preTransformed)
 		{
 			clipFlags &= 0xFBFBFBFB;   // Don't clip against far clip plane
@@ -23,6 +23,7 @@ namespace sw
 {
 	VertexShader::VertexShader(const VertexShader *vs) : Shader()
 	{
+		shaderType = SHADER_VERTEX;
 		shaderModel = 0x0300;
 		positionRegister = Pos;
 		pointSizeRegister = Unused;
@@ -38,6 +39,8 @@ namespace sw
 
 		if(vs)   // Make a copy
 		{
+			shaderModel = vs->shaderModel;
+
 			for(size_t i = 0; i < vs->getLength(); i++)
 			{
 				append(new sw::Shader::Instruction(*vs->getInstruction(i)));
@@ -57,6 +60,18 @@ namespace sw
 		}
 	}
 
+	VertexShader::VertexShader(const VertexShader &vs) : Shader(vs)
+	{
+		memcpy(input, vs.input, sizeof(input));
+		memcpy(output, vs.output, sizeof(output));
+		memcpy(attribType, vs.attribType, sizeof(attribType));
+		positionRegister = vs.positionRegister;
+		pointSizeRegister = vs.pointSizeRegister;
+		instanceIdDeclared = vs.instanceIdDeclared;
+		vertexIdDeclared = vs.vertexIdDeclared;
+		textureSampling = vs.textureSampling;
+	}
+
 	VertexShader::VertexShader(const unsigned long *token) : Shader()
 	{
 		parse(token);
@@ -327,4 +342,27 @@ namespace sw
 			}
 		}
 	}
+
+	void VertexShader::hashData(std::vector<unsigned int> &data) const
+	{
+		Shader::hashData(data);
+
+		for(int i = 0; i < MAX_VERTEX_INPUTS; i++)
+		{
+			data.push_back(input[i].usage | input[i].index << 8 | attribType[i] << 16);
+		}
+
+		for(int i = 0; i < MAX_VERTEX_OUTPUTS; i++)
+		{
+			for(int j = 0; j < 4; j++)
+			{
+				const Semantic &semantic = output[i][j];
+				data.push_back(semantic.usage | semantic.index << 8 | semantic.centroid << 16 | semantic.flat << 17);
+			}
+		}
+
+		data.push_back(positionRegister);
+		data.push_back(pointSizeRegister);
+		data.push_back(instanceIdDeclared | vertexIdDeclared << 1 | textureSampling << 2);
+	}
 }
@@ -33,6 +33,7 @@ namespace sw
 		};
 
 		explicit VertexShader(const VertexShader *vs = 0);
+		VertexShader(const VertexShader &vs);   // Copies a linked shader without reanalyzing it
 		explicit VertexShader(const unsigned long *token);
 
 		virtual ~VertexShader();
@@ -61,6 +62,8 @@ namespace sw
 		void analyzeOutput();
 		void analyzeTextureSampling();
 
+		void hashData(std::vector<unsigned int> &data) const override;
+
 		Semantic input[MAX_VERTEX_INPUTS];
 		Semantic output[MAX_VERTEX_OUTPUTS][4];
 
@@ -0,0 +1,225 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the CPU overhead of OpenGL ES draw calls. Each draw renders a single
+// triangle covering a few pixels, so the time is dominated by the work done to
+// validate and apply state. The draws either leave all state unchanged, or
+// change one piece of state or one uniform in between.
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace
+{
+	const int WIDTH = 64;
+	const int HEIGHT = 64;
+	const int TEXTURES = 4;
+
+	const char *vertexShader =
+		"attribute vec2 position;\n"
+		"uniform vec2 offset;\n"
+		"varying vec2 texCoord;\n"
+		"void main()\n"
+		"{\n"
+		"	texCoord = position;\n"
+		"	gl_Position = vec4(position * 0.1 + offset, 0.0, 1.0);\n"
+		"}\n";
+
+	const char *fragmentShader =
+		"precision mediump float;\n"
+		"uniform sampler2D texture[4];\n"
+		"varying vec2 texCoord;\n"
+		"void main()\n"
+		"{\n"
+		"	gl_FragColor = texture2D(texture[0], texCoord) + texture2D(texture[1], texCoord) +\n"
+		"	               texture2D(texture[2], texCoord) + texture2D(texture[3], texCoord);\n"
+		"}\n";
+
+	enum Variant
+	{
+		UNCHANGED,
+		BLEND_FUNC,
+		UNIFORM,
+		VARIANT_COUNT
+	};
+
+	const char *variantName[VARIANT_COUNT] =
+	{
+		"no state changes",
+		"blend function change",
+		"uniform change",
+	};
+
+	GLuint compileShader(GLenum type, const char *source)
+	{
+		GLuint shader = glCreateShader(type);
+		glShaderSource(shader, 1, &source, nullptr);
+		glCompileShader(shader);
+
+		GLint compiled = GL_FALSE;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+
+		if(!compiled)
+		{
+			printf("error: shader compilation failed\n");
+			exit(EXIT_FAILURE);
+		}
+
+		return shader;
+	}
+
+	void setUp()
+	{
+		GLuint program = glCreateProgram();
+		glAttachShader(program, compileShader(GL_VERTEX_SHADER, vertexShader));
+		glAttachShader(program, compileShader(GL_FRAGMENT_SHADER, fragmentShader));
+		glBindAttribLocation(program, 0, "position");
+		glLinkProgram(program);
+		glUseProgram(program);
+
+		static const float positions[] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f};
+
+		GLuint buffer;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(positions), positions, GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+		glEnableVertexAttribArray(0);
+
+		for(int i = 0; i < TEXTURES; i++)
+		{
+			unsigned char texel[4] = {(unsigned char)(16 * i), 32, 64, 255};
+
+			GLuint texture;
+			glGenTextures(1, &texture);
+			glActiveTexture(GL_TEXTURE0 + i);
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+			char name[16];
+			snprintf(name, sizeof(name), "texture[%d]", i);
+			glUniform1i(glGetUniformLocation(program, name), i);
+		}
+
+		glUniform2f(glGetUniformLocation(program, "offset"), 0.0f, 0.0f);
+
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+	}
+
+	double run(Variant variant, int draws)
+	{
+		GLint program;
+		glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+		GLint offset = glGetUniformLocation(program, "offset");
+
+		glFinish();
+		auto start = std::chrono::steady_clock::now();
+
+		for(int i = 0; i < draws; i++)
+		{
+			switch(variant)
+			{
+			case UNCHANGED:
+				break;
+			case BLEND_FUNC:
+				glBlendFunc(GL_ONE, (i & 1) ? GL_ONE : GL_ZERO);
+				break;
+			case UNIFORM:
+				glUniform2f(offset, (i & 7) * 0.1f - 0.4f, 0.0f);
+				break;
+			default:
+				break;
+			}
+
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+		}
+
+		glFinish();
+		std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+		return seconds.count();
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int draws = (argc > 1) ? atoi(argv[1]) : 100000;
+
+	if(draws < 1)
+	{
+		printf("usage: %s [draw count]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	eglInitialize(display, nullptr, nullptr);
+
+	const EGLint configAttributes[] =
+	{
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_NONE
+	};
+
+	EGLConfig config;
+	EGLint configCount = 0;
+	eglChooseConfig(display, configAttributes, &config, 1, &configCount);
+
+	if(configCount != 1)
+	{
+		printf("error: no suitable EGL config\n");
+		return EXIT_FAILURE;
+	}
+
+	const EGLint surfaceAttributes[] = {EGL_WIDTH, WIDTH, EGL_HEIGHT, HEIGHT, EGL_NONE};
+	EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+
+	const EGLint contextAttributes[] = {EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE};
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+	eglMakeCurrent(display, surface, surface, context);
+
+	setUp();
+	run(UNCHANGED, draws / 10 + 1);   // Warm up the routine caches
+
+	printf("variant                  draws/s  us/draw\n");
+
+	for(int variant = 0; variant < VARIANT_COUNT; variant++)
+	{
+		double seconds = run((Variant)variant, draws);
+
+		printf("%-21s  %10.0f  %7.3f\n", variantName[variant], draws / seconds, seconds / draws * 1e6);
+	}
+
+	GLenum error = glGetError();
+
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext(display, context);
+	eglDestroySurface(display, surface);
+	eglTerminate(display);
+
+	if(error != GL_NO_ERROR)
+	{
+		printf("error: GL error 0x%04X\n", error);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
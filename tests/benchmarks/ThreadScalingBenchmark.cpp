@@ -0,0 +1,239 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures how rendering throughput scales with the Renderer's thread count.
+// For each count from 1 to N the thread count is written to SwiftShader.ini in
+// the working directory, and a new context renders frames of many small,
+// overlapping triangles, which exercises both primitive and pixel task
+// scheduling. The original ThreadCount setting is restored afterwards.
+
+#include "Common/Configurator.hpp"
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+namespace
+{
+	const int WIDTH = 1024;
+	const int HEIGHT = 1024;
+	const int GRID = 64;   // Quads per row and column
+	const int LAYERS = 4;   // Overdraw
+
+	const char *vertexShader =
+		"attribute vec3 position;\n"
+		"varying vec2 texCoord;\n"
+		"void main()\n"
+		"{\n"
+		"	texCoord = position.xy * 4.0;\n"
+		"	gl_Position = vec4(position, 1.0);\n"
+		"}\n";
+
+	const char *fragmentShader =
+		"precision mediump float;\n"
+		"varying vec2 texCoord;\n"
+		"void main()\n"
+		"{\n"
+		"	vec2 f = fract(texCoord);\n"
+		"	gl_FragColor = vec4(f, sin(f.x * f.y * 6.28), 1.0);\n"
+		"}\n";
+
+	GLuint compileShader(GLenum type, const char *source)
+	{
+		GLuint shader = glCreateShader(type);
+		glShaderSource(shader, 1, &source, nullptr);
+		glCompileShader(shader);
+
+		GLint compiled = GL_FALSE;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+
+		if(!compiled)
+		{
+			printf("error: shader compilation failed\n");
+			exit(EXIT_FAILURE);
+		}
+
+		return shader;
+	}
+
+	int setUp()
+	{
+		GLuint program = glCreateProgram();
+		glAttachShader(program, compileShader(GL_VERTEX_SHADER, vertexShader));
+		glAttachShader(program, compileShader(GL_FRAGMENT_SHADER, fragmentShader));
+		glBindAttribLocation(program, 0, "position");
+		glLinkProgram(program);
+		glUseProgram(program);
+
+		std::vector<float> positions;
+
+		for(int layer = 0; layer < LAYERS; layer++)
+		{
+			float z = 0.5f - 0.25f * layer;   // Front to back, so depth testing rejects some of the pixels
+			float shift = 0.5f * layer / GRID;
+
+			for(int y = 0; y < GRID; y++)
+			{
+				for(int x = 0; x < GRID; x++)
+				{
+					float x0 = 2.0f * x / GRID - 1.0f + shift;
+					float y0 = 2.0f * y / GRID - 1.0f + shift;
+					float x1 = x0 + 2.0f / GRID;
+					float y1 = y0 + 2.0f / GRID;
+
+					const float quad[] = {x0, y0, z, x1, y0, z, x0, y1, z, x0, y1, z, x1, y0, z, x1, y1, z};
+					positions.insert(positions.end(), quad, quad + 18);
+				}
+			}
+		}
+
+		GLuint buffer;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), positions.data(), GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+		glEnableVertexAttribArray(0);
+
+		glEnable(GL_DEPTH_TEST);
+
+		return (int)positions.size() / 3;
+	}
+
+	double run(int vertexCount, int frames)
+	{
+		glFinish();
+		auto start = std::chrono::steady_clock::now();
+
+		for(int i = 0; i < frames; i++)
+		{
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+		}
+
+		glFinish();
+		std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+		return seconds.count();
+	}
+
+	void setThreadCount(const std::string &threadCount)
+	{
+		sw::Configurator ini("SwiftShader.ini");
+		ini.addValue("Processor", "ThreadCount", threadCount);
+		ini.writeFile();
+	}
+
+	// Returns the frame rate of a context created with the given thread count
+	double measure(EGLDisplay display, EGLConfig config, int threadCount, int frames)
+	{
+		setThreadCount(std::to_string(threadCount));   // Read by the context's Renderer
+
+		const EGLint surfaceAttributes[] = {EGL_WIDTH, WIDTH, EGL_HEIGHT, HEIGHT, EGL_NONE};
+		EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+
+		const EGLint contextAttributes[] = {EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE};
+		EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+		eglMakeCurrent(display, surface, surface, context);
+
+		int vertexCount = setUp();
+		run(vertexCount, 1);   // Warm up the routine caches
+
+		double seconds = run(vertexCount, frames);
+
+		if(glGetError() != GL_NO_ERROR)
+		{
+			printf("error: GL error\n");
+			exit(EXIT_FAILURE);
+		}
+
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext(display, context);
+		eglDestroySurface(display, surface);
+
+		return frames / seconds;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int maxThreads = (argc > 1) ? atoi(argv[1]) : 16;
+	int frames = (argc > 2) ? atoi(argv[2]) : 20;
+
+	if(maxThreads < 1 || maxThreads > 16 || frames < 1)
+	{
+		printf("usage: %s [max thread count, up to 16] [frame count]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	struct stat status;
+	bool iniExisted = stat("SwiftShader.ini", &status) == 0;
+	std::string originalThreadCount = sw::Configurator("SwiftShader.ini").getValue("Processor", "ThreadCount");
+
+	EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	eglInitialize(display, nullptr, nullptr);
+
+	const EGLint configAttributes[] =
+	{
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_DEPTH_SIZE, 24,
+		EGL_NONE
+	};
+
+	EGLConfig config;
+	EGLint configCount = 0;
+	eglChooseConfig(display, configAttributes, &config, 1, &configCount);
+
+	if(configCount != 1)
+	{
+		printf("error: no suitable EGL config\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("threads   frames/s  speedup\n");
+
+	double singleThreaded = 0.0;
+
+	for(int threadCount = 1; threadCount <= maxThreads; threadCount++)
+	{
+		double rate = measure(display, config, threadCount, frames);
+
+		if(threadCount == 1)
+		{
+			singleThreaded = rate;
+		}
+
+		printf("%7d  %9.2f  %7.2f\n", threadCount, rate, rate / singleThreaded);
+	}
+
+	eglTerminate(display);
+
+	if(!iniExisted)
+	{
+		remove("SwiftShader.ini");
+	}
+	else
+	{
+		setThreadCount(originalThreadCount.empty() ? "0" : originalThreadCount);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Depth writes which don't go through the rasterizer must invalidate the
+// hierarchical Z of the tiles they touch, otherwise later draws could reject
+// tiles which now contain nearer depth values.
+
+#include "Renderer/Surface.hpp"
+#include "Renderer/Blitter.hpp"
+#include "Main/Config.hpp"
+
+#include "gtest/gtest.h"
+
+#include <limits>
+
+using namespace sw;
+
+namespace
+{
+	const int WIDTH = 4 << TILE_SHIFT;
+	const int HEIGHT = 2 << TILE_SHIFT;
+	const int TILE = 1 << TILE_SHIFT;
+
+	class HierarchicalZTest : public testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			depthBuffer = createDepthBuffer();
+			ASSERT_TRUE(depthBuffer->hasHiZ());
+			ASSERT_NE(depthBuffer->getHiZ(), nullptr);
+
+			depthBuffer->clearDepth(0.5f, 0, 0, WIDTH, HEIGHT);   // Makes every tile's maximum depth known
+			expectTiles(0.5f);
+		}
+
+		void TearDown() override
+		{
+			delete depthBuffer;
+		}
+
+		static Surface *createDepthBuffer()
+		{
+			return Surface::create(nullptr, WIDTH, HEIGHT, 1, 0, 1, FORMAT_D32F, true, true);
+		}
+
+		float tile(int tx, int ty)
+		{
+			return depthBuffer->getHiZ()[ty * depthBuffer->getTilePitch() + tx];
+		}
+
+		void expectTiles(float depth)
+		{
+			for(int ty = 0; ty < HEIGHT / TILE; ty++)
+			{
+				for(int tx = 0; tx < WIDTH / TILE; tx++)
+				{
+					EXPECT_EQ(tile(tx, ty), depth) << "tile " << tx << ", " << ty;
+				}
+			}
+		}
+
+		const float unknown = std::numeric_limits<float>::infinity();
+
+		Surface *depthBuffer = nullptr;
+	};
+}
+
+TEST_F(HierarchicalZTest, PartialClearInvalidatesPartiallyCoveredTiles)
+{
+	depthBuffer->clearDepth(0.75f, 0, 0, TILE + TILE / 2, TILE);
+
+	EXPECT_EQ(tile(0, 0), 0.75f);   // Fully covered
+	EXPECT_EQ(tile(1, 0), unknown);
+}
+
+TEST_F(HierarchicalZTest, BlitInvalidates)
+{
+	Surface *source = createDepthBuffer();
+	source->clearDepth(0.25f, 0, 0, WIDTH, HEIGHT);
+
+	Blitter blitter;
+	blitter.blit(source, SliceRectF(0, 0, TILE, TILE, 0), depthBuffer, SliceRect(0, 0, TILE, TILE, 0), {false, false, false});
+
+	EXPECT_EQ(tile(0, 0), unknown);
+
+	delete source;
+}
+
+TEST_F(HierarchicalZTest, ExternalWriteInvalidates)
+{
+	depthBuffer->lockExternal(0, 0, 0, LOCK_WRITEONLY, PUBLIC);
+	depthBuffer->unlockExternal();
+
+	expectTiles(unknown);
+}
+
+TEST_F(HierarchicalZTest, InternalWriteInvalidates)
+{
+	depthBuffer->lockInternal(0, 0, 0, LOCK_READWRITE, PUBLIC);
+	depthBuffer->unlockInternal();
+
+	expectTiles(unknown);
+}
+
+TEST_F(HierarchicalZTest, ReadDoesNotInvalidate)
+{
+	depthBuffer->lockExternal(0, 0, 0, LOCK_READONLY, PUBLIC);
+	depthBuffer->unlockExternal();
+	depthBuffer->lockInternal(0, 0, 0, LOCK_READONLY, PUBLIC);
+	depthBuffer->unlockInternal();
+
+	expectTiles(0.5f);
+}
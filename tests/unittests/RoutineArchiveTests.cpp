@@ -0,0 +1,160 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Renderer/RoutineArchive.hpp"
+#include "Renderer/RoutineCompiler.hpp"
+#include "Renderer/Renderer.hpp"
+#include "Reactor/Routine.hpp"
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace sw;
+
+namespace
+{
+	// Stands in for a compiled routine, the archive only needs its object code
+	class ObjectRoutine : public Routine
+	{
+	public:
+		explicit ObjectRoutine(const std::vector<uint8_t> &object) : object(object)
+		{
+		}
+
+		const void *getEntry() override
+		{
+			return object.data();
+		}
+
+		const void *getObject(size_t &size) override
+		{
+			size = object.size();
+			return object.data();
+		}
+
+	private:
+		const std::vector<uint8_t> object;
+	};
+
+	struct Key
+	{
+		int a;
+		int b;
+	};
+
+	const char *const archiveName = "sw-archive-test";
+
+	class RoutineArchiveTest : public testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			precacheDirectory = testing::TempDir();
+			remove(fileName().c_str());
+		}
+
+		void TearDown() override
+		{
+			remove(fileName().c_str());
+			precacheDirectory.clear();
+		}
+
+		static std::string fileName()
+		{
+			return precacheDirectory + "/" + archiveName + ".cache";
+		}
+
+		static bool contains(RoutineArchive &archive, const Key &key, uint64_t hash, const std::vector<uint8_t> &object)
+		{
+			size_t size = 0;
+			const void *found = archive.find(&key, hash, size);
+
+			return found && size == object.size() && memcmp(found, object.data(), size) == 0;
+		}
+
+		const Key key = {1, 2};
+		const uint64_t hash = 0x0123456789ABCDEFull;
+		const std::vector<uint8_t> object = {0x55, 0x48, 0x89, 0xE5, 0xC3};
+	};
+}
+
+TEST_F(RoutineArchiveTest, StoredRoutineIsFoundAfterReload)
+{
+	{
+		RoutineArchive archive(archiveName, sizeof(Key));
+		Routine *routine = new ObjectRoutine(object);
+		routine->bind();
+
+		archive.store(&key, hash, routine);
+		EXPECT_TRUE(contains(archive, key, hash, object));
+
+		routine->unbind();
+	}   // Written on destruction
+
+	RoutineArchive archive(archiveName, sizeof(Key));
+
+	EXPECT_TRUE(contains(archive, key, hash, object));
+
+	const Key otherKey = {1, 3};
+	size_t size = 0;
+	EXPECT_EQ(archive.find(&otherKey, hash, size), nullptr);
+}
+
+TEST_F(RoutineArchiveTest, FingerprintMismatchIsRejected)
+{
+	{
+		RoutineArchive archive(archiveName, sizeof(Key));
+		Routine *routine = new ObjectRoutine(object);
+		routine->bind();
+
+		archive.store(&key, hash, routine);
+
+		routine->unbind();
+	}
+
+	TranscendentalPrecision precision = logPrecision;
+	logPrecision = (precision == IEEE) ? WHQL : IEEE;   // Changes the generated code
+
+	{
+		RoutineArchive archive(archiveName, sizeof(Key));
+		EXPECT_FALSE(contains(archive, key, hash, object));
+	}
+
+	logPrecision = precision;
+
+	RoutineArchive archive(archiveName, sizeof(Key));
+	EXPECT_TRUE(contains(archive, key, hash, object));   // Only replaced when the mismatching one stores routines
+}
+
+TEST_F(RoutineArchiveTest, DeferredRoutineIsStoredOnceCompiled)
+{
+	{
+		RoutineArchive archive(archiveName, sizeof(Key));
+		DeferredRoutine *routine = new DeferredRoutine(true);
+		routine->bind();
+
+		archive.store(&key, hash, routine);
+		EXPECT_FALSE(contains(archive, key, hash, object));
+
+		routine->resolve(new ObjectRoutine(object));
+		routine->unbind();
+	}
+
+	RoutineArchive archive(archiveName, sizeof(Key));
+
+	EXPECT_TRUE(contains(archive, key, hash, object));
+}
@@ -0,0 +1,114 @@
+// Copyright 2016 The SwiftShader Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Renderer/RoutineCompiler.hpp"
+#include "Reactor/Routine.hpp"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+
+using namespace sw;
+
+namespace
+{
+	// Stands in for a compiled routine, its entry only has to be distinguishable
+	class EntryRoutine : public Routine
+	{
+	public:
+		explicit EntryRoutine(const void *entry) : entry(entry)
+		{
+		}
+
+		const void *getEntry() override
+		{
+			return entry;
+		}
+
+	private:
+		const void *const entry;
+	};
+
+	void compiled(void *parameters)
+	{
+	}
+
+	const int baselineEntry = 1;
+	const int optimizedEntry = 2;
+}
+
+TEST(TieredRoutineTest, SwapsEntryAfterThresholdUses)
+{
+	const int threshold = 4;
+
+	std::atomic<int> optimizations(0);   // Outlives the compiler's jobs
+	RoutineCompiler compiler(1, compiled, nullptr);
+
+	Routine *baseline = new EntryRoutine(&baselineEntry);
+	baseline->bind();   // Taken over by the tiered routine
+
+	Routine *routine = new TieredRoutine(baseline, [&optimizations]() -> Routine*
+	{
+		optimizations++;
+		return new EntryRoutine(&optimizedEntry);
+	}, threshold, &compiler);
+	routine->bind();
+
+	for(int i = 0; i < threshold; i++)
+	{
+		EXPECT_EQ(routine->getEntry(), &baselineEntry);
+	}
+
+	compiler.finish();
+
+	EXPECT_EQ(optimizations, 1);
+	EXPECT_EQ(routine->getEntry(), &optimizedEntry);
+	EXPECT_EQ(routine->getEntry(), &optimizedEntry);
+
+	compiler.finish();
+
+	EXPECT_EQ(optimizations, 1);   // Only recompiled once
+
+	routine->unbind();
+}
+
+TEST(TieredRoutineTest, KeepsBaselineBelowThreshold)
+{
+	const int threshold = 4;
+
+	std::atomic<int> optimizations(0);   // Outlives the compiler's jobs
+	RoutineCompiler compiler(1, compiled, nullptr);
+
+	Routine *baseline = new EntryRoutine(&baselineEntry);
+	baseline->bind();
+
+	Routine *routine = new TieredRoutine(baseline, [&optimizations]() -> Routine*
+	{
+		optimizations++;
+		return new EntryRoutine(&optimizedEntry);
+	}, threshold, &compiler);
+	routine->bind();
+
+	for(int i = 0; i < threshold - 1; i++)
+	{
+		EXPECT_EQ(routine->getEntry(), &baselineEntry);
+	}
+
+	compiler.finish();
+
+	EXPECT_EQ(optimizations, 0);
+	EXPECT_EQ(routine->getEntry(), &baselineEntry);   // The threshold'th use, which starts the recompile
+
+	routine->unbind();
+}